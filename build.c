@@ -37,14 +37,15 @@
 #define builder_cc(cmd) cmd_append(cmd, "cc")
 #define builder_output(cmd, output_path) cmd_append(cmd, "-o", output_path)
 #define builder_inputs(cmd, ...) cmd_append(cmd, __VA_ARGS__)
-#define builder_libs(cmd) cmd_append(cmd, "-lm")
+#define builder_libs(cmd) cmd_append(cmd, "-lm", "-lpthread")
 #define builder_flags(cmd)                                                     \
   cmd_append(cmd, "-Wall", "-Wextra", "-Wswitch-enum", "-ggdb")
 #define builder_include_path(cmd, include_path)                                \
   cmd_append(cmd, temp_sprintf("-I%s", include_path))
 
 /* ----- OPENGL ----- */
-#define builder_opengl(cmd) cmd_append(cmd, "-lglfw", "-lGL", "-lGLEW", "-ldl")
+#define builder_opengl(cmd)                                                    \
+  cmd_append(cmd, "-lglfw", "-lGL", "-lEGL", "-lGLEW", "-ldl")
 
 /* ----- RAYLIB ----- */
 #define builder_raylib(cmd)                                                    \
@@ -56,6 +57,22 @@
   cmd_append(cmd, temp_sprintf("-I%s", FREETYPE_INCLUDE_PATH),                 \
              temp_sprintf("-L%s", FREETYPE_LIBRARY_PATH), "-lfreetype")
 
+/* ----- PROFILER ----- */
+// PROFILE=1 ./build run compiles the profiling zones in
+#define builder_profiler(cmd)                                                  \
+  do {                                                                         \
+    if (getenv("PROFILE") != NULL)                                             \
+      cmd_append(cmd, "-DPROFILER_ENABLED");                                   \
+  } while (0)
+
+/* ----- ARENA STATS ----- */
+// ARENA_STATS=1 ./build run reports arena usage on exit
+#define builder_arena_stats(cmd)                                               \
+  do {                                                                         \
+    if (getenv("ARENA_STATS") != NULL)                                         \
+      cmd_append(cmd, "-DARENA_STATS");                                        \
+  } while (0)
+
 /* ----- BUILD FILES ----- */
 #define builder_inputs_list(cmd, files)                                        \
   do {                                                                         \
@@ -71,13 +88,110 @@ int main(int argc, char *argv[]) {
   const char *SRC_FILES[] = {
       "src/main.c",
       "src/control/game_app.c",
+      "src/assets/assets.c",
+      "src/assets/pack.c",
+      "src/input/input.c",
+      "src/input/record.c",
+      "src/jobs/jobs.c",
       "src/utils/utils.c",
       "src/utils/errors.c",
+      "src/utils/memory.c",
+      "src/utils/pool.c",
+      "src/profiler/profiler.c",
+      "src/profiler/gpu_profiler.c",
+      "src/renderer/buffer_ring.c",
+      "src/renderer/capture.c",
+      "src/renderer/geometry_pool.c",
+      "src/renderer/gl_state.c",
+      "src/renderer/path_renderer.c",
+      "src/renderer/shader.c",
+      "src/renderer/text_renderer.c",
       NULL,
   };
 
+  const char *SPLINE_BINARY = "build/splines";
   const char *SPLINE_FILES[] = {
       "examples/splines/main.c",
+      "src/input/input.c",
+      "src/input/record.c",
+      "src/jobs/jobs.c",
+      "src/utils/memory.c",
+      "src/profiler/profiler.c",
+      NULL,
+  };
+
+  const char *PACK_BINARY = "build/pack";
+  const char *PACK_FILES[] = {
+      "src/assets/pack_tool.c",
+      "src/assets/pack.c",
+      "src/utils/memory.c",
+      NULL,
+  };
+
+  const char *TEST_BINARY = "build/test";
+  const char *TEST_FILES[] = {
+      "tests/test.c",
+      "tests/alloc_count.c",
+      "tests/frame_alloc_test.c",
+      "tests/jobs_test.c",
+      "tests/gl_state_test.c",
+      "src/control/game_app.c",
+      "src/assets/assets.c",
+      "src/assets/pack.c",
+      "src/input/input.c",
+      "src/input/record.c",
+      "src/jobs/jobs.c",
+      "src/utils/utils.c",
+      "src/utils/errors.c",
+      "src/utils/memory.c",
+      "src/utils/pool.c",
+      "src/profiler/profiler.c",
+      "src/profiler/gpu_profiler.c",
+      "src/renderer/buffer_ring.c",
+      "src/renderer/capture.c",
+      "src/renderer/geometry_pool.c",
+      "src/renderer/gl_state.c",
+      "src/renderer/path_renderer.c",
+      "src/renderer/shader.c",
+      "src/renderer/text_renderer.c",
+      NULL,
+  };
+
+  // tests/arena_test.c builds once per backend, arena.h is header-only
+  const char *ARENA_TEST_BACKENDS[][2] = {
+      {"build/test_arena_libc", "-DARENA_BACKEND=ARENA_BACKEND_LIBC_MALLOC"},
+      {"build/test_arena_mmap", "-DARENA_BACKEND=ARENA_BACKEND_LINUX_MMAP"},
+      {"build/test_arena_vmem", "-DARENA_BACKEND=ARENA_BACKEND_LINUX_VMEM"},
+  };
+
+  const char *BENCH_BINARY = "build/bench";
+  const char *BENCH_FILES[] = {
+      "tests/bench.c",
+      "tests/shader_bench.c",
+      "tests/arena_bench.c",
+      "tests/pool_bench.c",
+      "tests/jobs_bench.c",
+      "tests/text_bench.c",
+      "tests/scene_bench.c",
+      "src/control/game_app.c",
+      "src/assets/assets.c",
+      "src/assets/pack.c",
+      "src/input/input.c",
+      "src/input/record.c",
+      "src/jobs/jobs.c",
+      "src/utils/utils.c",
+      "src/utils/errors.c",
+      "src/utils/memory.c",
+      "src/utils/pool.c",
+      "src/profiler/profiler.c",
+      "src/profiler/gpu_profiler.c",
+      "src/renderer/buffer_ring.c",
+      "src/renderer/capture.c",
+      "src/renderer/geometry_pool.c",
+      "src/renderer/gl_state.c",
+      "src/renderer/path_renderer.c",
+      "src/renderer/shader.c",
+      "src/renderer/text_renderer.c",
       NULL,
   };
 
@@ -88,6 +202,8 @@ int main(int argc, char *argv[]) {
   builder_inputs_list(&cmd, SRC_FILES);
   builder_libs(&cmd);
   builder_flags(&cmd);
+  builder_profiler(&cmd);
+  builder_arena_stats(&cmd);
   builder_opengl(&cmd);
   builder_raylib(&cmd);
   builder_freetype2(&cmd);
@@ -103,6 +219,95 @@ int main(int argc, char *argv[]) {
 
     if (strcmp(subcommand, "run") == 0) {
       cmd_append(&cmd, BINARY);
+      while (argc > 0)
+        cmd_append(&cmd, shift(argv, argc));
+      if (!cmd_run_sync_and_reset(&cmd))
+        return 1;
+    } else if (strcmp(subcommand, "splines") == 0) {
+      builder_cc(&cmd);
+      builder_output(&cmd, SPLINE_BINARY);
+      builder_inputs_list(&cmd, SPLINE_FILES);
+      builder_libs(&cmd);
+      builder_flags(&cmd);
+      builder_profiler(&cmd);
+      builder_arena_stats(&cmd);
+      builder_opengl(&cmd);
+      builder_raylib(&cmd);
+      builder_freetype2(&cmd);
+      builder_macos_frameworks(&cmd);
+      if (!cmd_run_sync_and_reset(&cmd))
+        return 1;
+
+      cmd_append(&cmd, SPLINE_BINARY);
+      while (argc > 0)
+        cmd_append(&cmd, shift(argv, argc));
+      if (!cmd_run_sync_and_reset(&cmd))
+        return 1;
+    } else if (strcmp(subcommand, "pack") == 0) {
+      builder_cc(&cmd);
+      builder_output(&cmd, PACK_BINARY);
+      builder_inputs_list(&cmd, PACK_FILES);
+      builder_libs(&cmd);
+      builder_flags(&cmd);
+      if (!cmd_run_sync_and_reset(&cmd))
+        return 1;
+
+      cmd_append(&cmd, PACK_BINARY);
+      while (argc > 0)
+        cmd_append(&cmd, shift(argv, argc));
+      cmd_append(&cmd, "assets", "build/assets.pack");
+      if (!cmd_run_sync_and_reset(&cmd))
+        return 1;
+    } else if (strcmp(subcommand, "test") == 0) {
+      for (size_t i = 0; i < ARRAY_LEN(ARENA_TEST_BACKENDS); ++i) {
+        builder_cc(&cmd);
+        builder_output(&cmd, ARENA_TEST_BACKENDS[i][0]);
+        builder_inputs(&cmd, "tests/arena_test.c", ARENA_TEST_BACKENDS[i][1]);
+        builder_libs(&cmd);
+        builder_flags(&cmd);
+        if (!cmd_run_sync_and_reset(&cmd))
+          return 1;
+        cmd_append(&cmd, ARENA_TEST_BACKENDS[i][0]);
+        if (!cmd_run_sync_and_reset(&cmd))
+          return 1;
+      }
+
+      builder_cc(&cmd);
+      builder_output(&cmd, TEST_BINARY);
+      builder_inputs_list(&cmd, TEST_FILES);
+      builder_libs(&cmd);
+      builder_flags(&cmd);
+      // Counts the malloc family calls of every file, see the header
+      cmd_append(&cmd, "-include", "tests/alloc_count.h");
+      builder_opengl(&cmd);
+      builder_raylib(&cmd);
+      builder_freetype2(&cmd);
+      builder_macos_frameworks(&cmd);
+      if (!cmd_run_sync_and_reset(&cmd))
+        return 1;
+
+      cmd_append(&cmd, TEST_BINARY);
+      while (argc > 0)
+        cmd_append(&cmd, shift(argv, argc));
+      if (!cmd_run_sync_and_reset(&cmd))
+        return 1;
+    } else if (strcmp(subcommand, "bench") == 0) {
+      builder_cc(&cmd);
+      builder_output(&cmd, BENCH_BINARY);
+      builder_inputs_list(&cmd, BENCH_FILES);
+      builder_libs(&cmd);
+      builder_flags(&cmd);
+      cmd_append(&cmd, "-O2");
+      builder_opengl(&cmd);
+      builder_raylib(&cmd);
+      builder_freetype2(&cmd);
+      builder_macos_frameworks(&cmd);
+      if (!cmd_run_sync_and_reset(&cmd))
+        return 1;
+
+      cmd_append(&cmd, BENCH_BINARY);
+      while (argc > 0)
+        cmd_append(&cmd, shift(argv, argc));
       if (!cmd_run_sync_and_reset(&cmd))
         return 1;
     } else {
@@ -0,0 +1,240 @@
+// GPU fill: the spline's segments go into float textures and every fragment
+// of one quad over the spline's bounds counts its own winding number, so the
+// fill is exact at any resolution and an edit only costs an upload.
+//
+// segments  two texels per segment: (p1, p2), (p3, kind, 0)
+// bands     GPU_FILL_BANDS headers (start texel, count, 0, 0), then segment
+//           indices packed four per texel
+//
+// The bounds are cut into horizontal bands and each band lists the segments
+// overlapping it, so a fragment only tests the segments near its row.
+
+#define GPU_FILL_TEXTURE_WIDTH 256 // also hardcoded in fetch()
+#define GPU_FILL_BANDS 32
+
+static const char *gpu_fill_fragment_source =
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "uniform sampler2D segments;\n"
+    "uniform sampler2D bands;\n"
+    "uniform vec3 bandInfo;\n" // first row, band height, band count
+    "out vec4 finalColor;\n"
+    "vec4 fetch(sampler2D s, int i) {\n"
+    "  return texelFetch(s, ivec2(i % 256, i / 256), 0);\n"
+    "}\n"
+    // Signed crossings of the ray from p towards -x, +1 going up the screen
+    "int crossing(vec2 p, float t, float x, float dy) {\n"
+    "  if (t < 0.0 || t >= 1.0 || x >= p.x) return 0;\n"
+    "  return dy < 0.0 ? 1 : (dy > 0.0 ? -1 : 0);\n"
+    "}\n"
+    "int crossings(vec2 p, vec2 p1, vec2 p2, vec2 p3, bool quad) {\n"
+    "  if (!quad) {\n"
+    "    float dy = p2.y - p1.y;\n"
+    "    if (abs(dy) <= 1e-6) return 0;\n"
+    "    float t = (p.y - p1.y) / dy;\n"
+    "    return crossing(p, t, mix(p1.x, p2.x, t), dy);\n"
+    "  }\n"
+    "  vec2 a = p1 - 2.0 * p2 + p3;\n"
+    "  vec2 b = 2.0 * (p2 - p1);\n"
+    "  float c = p1.y - p.y;\n"
+    "  float t0, t1;\n"
+    "  if (abs(a.y) > 1e-6) {\n"
+    "    float D = b.y * b.y - 4.0 * a.y * c;\n"
+    "    if (D < 0.0) return 0;\n"
+    "    t0 = (-b.y + sqrt(D)) / (2.0 * a.y);\n"
+    "    t1 = (-b.y - sqrt(D)) / (2.0 * a.y);\n"
+    "  } else if (abs(b.y) > 1e-6) {\n"
+    "    t0 = -c / b.y;\n"
+    "    t1 = -1.0;\n"
+    "  } else {\n"
+    "    return 0;\n"
+    "  }\n"
+    "  return crossing(p, t0, (a.x * t0 + b.x) * t0 + p1.x, 2.0 * a.y * t0 + "
+    "b.y) +\n"
+    "         crossing(p, t1, (a.x * t1 + b.x) * t1 + p1.x, 2.0 * a.y * t1 + "
+    "b.y);\n"
+    "}\n"
+    "void main() {\n"
+    "  vec2 p = fragTexCoord;\n"
+    "  int band = clamp(int((p.y - bandInfo.x) / bandInfo.y), 0,\n"
+    "                   int(bandInfo.z) - 1);\n"
+    "  vec4 header = fetch(bands, band);\n"
+    "  int start = int(header.x);\n"
+    "  int count = int(header.y);\n"
+    "  int winding = 0;\n"
+    "  for (int k = 0; k < count; ++k) {\n"
+    "    int i = int(fetch(bands, start + k / 4)[k % 4]);\n"
+    "    vec4 a = fetch(segments, 2 * i);\n"
+    "    vec4 b = fetch(segments, 2 * i + 1);\n"
+    "    winding += crossings(p, a.xy, a.zw, b.xy, b.z > 0.5);\n"
+    "  }\n"
+    "  if (winding <= 0) discard;\n"
+    "  finalColor = fragColor;\n"
+    "}\n";
+
+typedef struct {
+  Shader shader;
+  int segments_loc;
+  int bands_loc;
+  int band_info_loc;
+  Texture2D segments;
+  Texture2D bands;
+  Rectangle bounds;
+  float band_info[3];
+  bool empty;
+} Gpu_Fill;
+
+bool gpu_fill_init(Gpu_Fill *fill) {
+  *fill = (Gpu_Fill){.empty = true};
+  fill->shader = LoadShaderFromMemory(NULL, gpu_fill_fragment_source);
+  if (!IsShaderValid(fill->shader))
+    return false;
+  fill->segments_loc = GetShaderLocation(fill->shader, "segments");
+  fill->bands_loc = GetShaderLocation(fill->shader, "bands");
+  fill->band_info_loc = GetShaderLocation(fill->shader, "bandInfo");
+  return true;
+}
+
+void gpu_fill_unload(Gpu_Fill *fill) {
+  if (fill->segments.id)
+    UnloadTexture(fill->segments);
+  if (fill->bands.id)
+    UnloadTexture(fill->bands);
+  UnloadShader(fill->shader);
+  *fill = (Gpu_Fill){.empty = true};
+}
+
+// Staging for `texels` RGBA32F texels, zeroed and padded to whole rows
+static float *gpu_fill_alloc_texels(Arena *arena, size_t texels) {
+  size_t rows = (texels + GPU_FILL_TEXTURE_WIDTH - 1) / GPU_FILL_TEXTURE_WIDTH;
+  size_t size = rows * GPU_FILL_TEXTURE_WIDTH * 4 * sizeof(float);
+  float *data = arena_alloc(arena, size);
+  memset(data, 0, size);
+  return data;
+}
+
+// Uploads the rows holding the first `texels` texels of `data`, growing the
+// texture when they don't fit
+static void gpu_fill_upload_texels(Texture2D *texture, const float *data,
+                                   size_t texels) {
+  int rows = (int)((texels + GPU_FILL_TEXTURE_WIDTH - 1) /
+                   GPU_FILL_TEXTURE_WIDTH);
+  if (rows > texture->height) {
+    if (texture->id)
+      UnloadTexture(*texture);
+    int height = texture->height > 0 ? texture->height : 1;
+    while (height < rows)
+      height *= 2;
+    Image image = {
+        .width = GPU_FILL_TEXTURE_WIDTH,
+        .height = height,
+        .mipmaps = 1,
+        .format = PIXELFORMAT_UNCOMPRESSED_R32G32B32A32,
+    };
+    *texture = LoadTextureFromImage(image);
+  }
+  Rectangle rows_rec = {0, 0, GPU_FILL_TEXTURE_WIDTH, rows};
+  UpdateTextureRec(*texture, rows_rec, data);
+}
+
+// `arena` only holds the staging data, the frame arena is fine
+void gpu_fill_upload(Gpu_Fill *fill, Arena *arena, const Spline *spline) {
+  PROFILE_FUNCTION();
+  fill->empty = spline->count == 0;
+  if (fill->empty)
+    return;
+
+  float min_x = spline->items[0].p1.x, max_x = min_x;
+  float min_y = spline->items[0].p1.y, max_y = min_y;
+  for (size_t i = 0; i < spline->count; ++i) {
+    Segment seg = spline->items[i];
+    Vector2 ps[3] = {seg.p1, seg.p2,
+                     seg.kind == SEGMENT_QUAD ? seg.p3 : seg.p2};
+    for (size_t j = 0; j < 3; ++j) {
+      min_x = fminf(min_x, ps[j].x);
+      max_x = fmaxf(max_x, ps[j].x);
+      min_y = fminf(min_y, ps[j].y);
+      max_y = fmaxf(max_y, ps[j].y);
+    }
+  }
+  fill->bounds = (Rectangle){min_x, min_y, max_x - min_x, max_y - min_y};
+  float band_height = fmaxf(fill->bounds.height / GPU_FILL_BANDS, 1e-3f);
+  fill->band_info[0] = min_y;
+  fill->band_info[1] = band_height;
+  fill->band_info[2] = GPU_FILL_BANDS;
+
+  // The control points bound each segment, which is all a band needs
+  size_t segment_texels = 2 * spline->count;
+  float *segments = gpu_fill_alloc_texels(arena, segment_texels);
+  int first[GPU_FILL_BANDS] = {0}, last[GPU_FILL_BANDS] = {0};
+  size_t counts[GPU_FILL_BANDS] = {0};
+  int *bands_of = arena_alloc(arena, 2 * spline->count * sizeof(int));
+  for (size_t i = 0; i < spline->count; ++i) {
+    Segment seg = spline->items[i];
+    Vector2 p3 = seg.kind == SEGMENT_QUAD ? seg.p3 : seg.p2;
+    float *t = &segments[8 * i];
+    t[0] = seg.p1.x, t[1] = seg.p1.y, t[2] = seg.p2.x, t[3] = seg.p2.y;
+    t[4] = p3.x, t[5] = p3.y, t[6] = seg.kind == SEGMENT_QUAD, t[7] = 0;
+
+    float lo = fminf(seg.p1.y, fminf(seg.p2.y, p3.y));
+    float hi = fmaxf(seg.p1.y, fmaxf(seg.p2.y, p3.y));
+    int b0 = (int)((lo - min_y) / band_height);
+    int b1 = (int)((hi - min_y) / band_height);
+    b0 = b0 < 0 ? 0 : (b0 >= GPU_FILL_BANDS ? GPU_FILL_BANDS - 1 : b0);
+    b1 = b1 < 0 ? 0 : (b1 >= GPU_FILL_BANDS ? GPU_FILL_BANDS - 1 : b1);
+    bands_of[2 * i] = b0;
+    bands_of[2 * i + 1] = b1;
+    for (int b = b0; b <= b1; ++b)
+      counts[b]++;
+  }
+
+  // Each band's index list starts on its own texel
+  size_t band_texels = GPU_FILL_BANDS;
+  for (int b = 0; b < GPU_FILL_BANDS; ++b) {
+    first[b] = (int)band_texels;
+    band_texels += (counts[b] + 3) / 4;
+  }
+  float *bands = gpu_fill_alloc_texels(arena, band_texels);
+  for (int b = 0; b < GPU_FILL_BANDS; ++b) {
+    bands[4 * b] = first[b];
+    bands[4 * b + 1] = counts[b];
+  }
+  for (size_t i = 0; i < spline->count; ++i) {
+    for (int b = bands_of[2 * i]; b <= bands_of[2 * i + 1]; ++b) {
+      bands[4 * first[b] + last[b]] = i;
+      last[b]++;
+    }
+  }
+
+  gpu_fill_upload_texels(&fill->segments, segments, segment_texels);
+  gpu_fill_upload_texels(&fill->bands, bands, band_texels);
+}
+
+void gpu_fill_draw(const Gpu_Fill *fill, Color color) {
+  PROFILE_FUNCTION();
+  if (fill->empty)
+    return;
+
+  // Texture coordinates carry the screen position into the shader
+  Rectangle r = fill->bounds;
+  float x0 = floorf(r.x) - 1, y0 = floorf(r.y) - 1;
+  float x1 = ceilf(r.x + r.width) + 1, y1 = ceilf(r.y + r.height) + 1;
+  BeginShaderMode(fill->shader);
+  SetShaderValueTexture(fill->shader, fill->segments_loc, fill->segments);
+  SetShaderValueTexture(fill->shader, fill->bands_loc, fill->bands);
+  SetShaderValue(fill->shader, fill->band_info_loc, fill->band_info,
+                 SHADER_UNIFORM_VEC3);
+  rlBegin(RL_QUADS);
+  rlColor4ub(color.r, color.g, color.b, color.a);
+  rlTexCoord2f(x0, y0);
+  rlVertex2f(x0, y0);
+  rlTexCoord2f(x0, y1);
+  rlVertex2f(x0, y1);
+  rlTexCoord2f(x1, y1);
+  rlVertex2f(x1, y1);
+  rlTexCoord2f(x1, y0);
+  rlVertex2f(x1, y0);
+  rlEnd();
+  EndShaderMode();
+}
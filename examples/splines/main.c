@@ -1,4 +1,5 @@
 #include "raster.c"
+#include "fill.c"
 
 typedef struct {
   Vector2 position;
@@ -11,7 +12,8 @@ typedef struct {
   size_t capacity;
 } Points;
 
-int render_font(Spline *spline) {
+int render_font(Arena *arena, Spline *spline) {
+  PROFILE_FUNCTION();
   FT_Library library = {0};
 
   FT_Error error = FT_Init_FreeType(&library);
@@ -69,7 +71,7 @@ int render_font(Spline *spline) {
           .position = {x, y},
           .on = t == FT_CURVE_TAG_ON,
       };
-      da_append(&points, point);
+      arena_da_append(arena, &points, point);
     }
   }
 
@@ -82,15 +84,107 @@ int render_font(Spline *spline) {
   return 0;
 }
 
-int main() {
+typedef struct {
+  InputEvent *items;
+  size_t count;
+  size_t capacity;
+} Input_Events;
+
+// The editor only looks at the cursor, the left button and `C`
+void poll_editor_input(Arena *arena, Input_Events *events,
+                       Vector2 *last_mouse) {
+  Vector2 mouse = GetMousePosition();
+  if (mouse.x != last_mouse->x || mouse.y != last_mouse->y) {
+    InputEvent event = {.type = INPUT_MOUSE_MOVE};
+    event.x = mouse.x;
+    event.y = mouse.y;
+    arena_da_append(arena, events, event);
+    *last_mouse = mouse;
+  }
+  if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+    InputEvent event = {.type = INPUT_MOUSE_BUTTON,
+                        .action = INPUT_PRESS,
+                        .code = MOUSE_LEFT_BUTTON};
+    arena_da_append(arena, events, event);
+  }
+  if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
+    InputEvent event = {.type = INPUT_MOUSE_BUTTON,
+                        .action = INPUT_RELEASE,
+                        .code = MOUSE_LEFT_BUTTON};
+    arena_da_append(arena, events, event);
+  }
+  if (IsKeyPressed(KEY_C)) {
+    InputEvent event = {
+        .type = INPUT_KEY, .action = INPUT_PRESS, .code = KEY_C};
+    arena_da_append(arena, events, event);
+  }
+}
+
+static double wall_time(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// [--record <file> | --replay <file>] [--timings <csv>] [--gpu] [--on-demand]
+//
+// A replay runs in a hidden window without the frame cap, one recorded frame
+// per frame, and quits at the end of the recording. --gpu fills the spline
+// in a fragment shader (fill.c) instead of rasterizing it into the grid.
+// --on-demand sleeps until there is input instead of redrawing at 60 FPS;
+// nothing in the editor changes without input.
+int main(int argc, char *argv[]) {
+  PROFILE_INIT();
+  PROFILE_THREAD_NAME("main");
+
+  const char *record_path = NULL;
+  const char *replay_path = NULL;
+  const char *timings_path = NULL;
+  bool gpu = false;
+  bool on_demand = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+      record_path = argv[++i];
+    } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+      replay_path = argv[++i];
+    } else if (strcmp(argv[i], "--timings") == 0 && i + 1 < argc) {
+      timings_path = argv[++i];
+    } else if (strcmp(argv[i], "--gpu") == 0) {
+      gpu = true;
+    } else if (strcmp(argv[i], "--on-demand") == 0) {
+      on_demand = true;
+    } else {
+      fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  jobs_init(0, false);
+
+  Arena persistent = {0};
+  InputReplay replay = {0};
+  InputRecorder recorder = {0};
+  if (replay_path && !input_replay_open(&replay, &persistent, replay_path))
+    return 1;
+  FILE *timings = NULL;
+  if (timings_path) {
+    timings = fopen(timings_path, "w");
+    if (!timings) {
+      fprintf(stderr, "Could not open `%s`\n", timings_path);
+      return 1;
+    }
+    fprintf(timings, "frame,ms\n");
+  }
 
   Control_Points control_points = {
       .dragging = -1,
   };
   Spline spline = {0};
+  Arena frame_arenas[2] = {0};
+  size_t frame = 0;
 
   // Spline spline_ = {0};
-  // int error = render_font(&spline_);
+  // int error = render_font(&frame_arenas[0], &spline_);
   // if (error != 0)
   //   return 1;
   // render_spline_into_grid(&spline_);
@@ -98,21 +192,98 @@ int main() {
   render_spline_into_grid(&spline);
 
   size_t factor = 80;
-  InitWindow(16 * factor, 9 * factor, "font");
-  SetTargetFPS(60);
+  int width = replay_path ? (int)replay.header.width : (int)(16 * factor);
+  int height = replay_path ? (int)replay.header.height : (int)(9 * factor);
+  if (replay_path)
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+  InitWindow(width, height, "font");
+  if (!replay_path)
+    SetTargetFPS(60);
+  // EndDrawing waits for events instead of polling, a replay has none
+  if (on_demand && !replay_path)
+    EnableEventWaiting();
+  if (record_path &&
+      !input_recorder_open(&recorder, record_path, width, height, 1.0 / 60.0))
+    return 1;
+  Gpu_Fill fill = {0};
+  if (gpu && !gpu_fill_init(&fill)) {
+    fprintf(stderr, "Could not compile the fill shader\n");
+    return 1;
+  }
+
+  InputState input = {0};
+  Vector2 last_mouse = {-1, -1};
+  double start = wall_time();
   while (!WindowShouldClose()) {
+    PROFILE_ZONE("frame");
+    double frame_start = wall_time();
+    Arena *frame_arena = &frame_arenas[frame & 1];
+    arena_reset(frame_arena);
+
+    input_state_begin_tick(&input);
+    if (replay_path) {
+      double time;
+      const InputEvent *events;
+      size_t count;
+      if (!input_replay_next(&replay, &time, &events, &count))
+        break;
+      for (size_t i = 0; i < count; ++i)
+        input_state_apply(&input, &events[i]);
+    } else {
+      Input_Events events = {0};
+      poll_editor_input(frame_arena, &events, &last_mouse);
+      for (size_t i = 0; i < events.count; ++i)
+        input_state_apply(&input, &events.items[i]);
+      input_recorder_frame(&recorder, frame_start - start, events.items,
+                           events.count);
+    }
+
     BeginDrawing();
     ClearBackground(GetColor(0x181818));
-    display_grid();
+    if (gpu) {
+      gpu_fill_draw(&fill, RED);
+    } else {
+      display_grid();
+      DrawText(TextFormat("grid upload: %zu B", grid_view.upload_bytes), 10,
+               10, 20, GRAY);
+    }
 
-    if (IsKeyPressed(KEY_C)) {
+    if (input.keys_pressed[KEY_C]) {
       control_points.count = 0;
       memset(grid, 0, sizeof(grid));
+      mark_grid_dirty();
+      fill.empty = true;
+    }
+    if (edit_control_points(frame_arena, &input, &control_points, &spline)) {
+      if (gpu) {
+        gpu_fill_upload(&fill, frame_arena, &spline);
+      } else {
+        render_spline_into_grid(&spline);
+      }
     }
-    edit_control_points(&control_points, &spline);
     EndDrawing();
+
+    if (timings)
+      fprintf(timings, "%zu,%.4f\n", frame, (wall_time() - frame_start) * 1000);
+    frame++;
   }
+  if (gpu)
+    gpu_fill_unload(&fill);
+  if (!gpu)
+    printf("grid uploads: %zu bytes over %zu frames\n",
+           grid_view.upload_bytes_total, frame);
+  unload_grid_display();
   CloseWindow();
+  input_recorder_close(&recorder);
+  if (timings)
+    fclose(timings);
+  arena_free(&frame_arenas[0]);
+  arena_free(&frame_arenas[1]);
+  arena_free(&persistent);
+  jobs_shutdown();
+
+  PROFILE_DUMP("splines_trace.json");
+  PROFILE_SHUTDOWN();
 
   return 0;
 }
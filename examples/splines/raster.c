@@ -4,6 +4,7 @@
 #include <rlgl.h>
 #include <stdio.h>
 #include <strings.h>
+#include <time.h>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -12,12 +13,21 @@
 #define NOB_STRIP_PREFIX
 #include "../../libs/nob.h"
 
+#include "../../src/input/record.h"
+#include "../../src/jobs/jobs.h"
+#include "../../src/profiler/profiler.h"
+#include "../../src/utils/memory.h"
+
 #define width_factor 4
 #define height_factor 3
+#ifndef windows_factor
 #define windows_factor 200
+#endif
 #define window_width (width_factor * windows_factor)
 #define window_height (height_factor * windows_factor)
+#ifndef grid_factor
 #define grid_factor 20
+#endif
 #define grid_width (width_factor * grid_factor)
 #define grid_height (height_factor * grid_factor)
 #define cell_width (size_t)(window_width / grid_width)
@@ -52,21 +62,137 @@ typedef struct {
 
 static bool grid[grid_height][grid_width] = {0};
 
-void display_grid(void) {
-  for (size_t y = 0; y < grid_height; ++y) {
-    for (size_t x = 0; x < grid_width; ++x) {
-      if (grid[y][x]) {
-        Vector2 marker_position = {x * cell_width, y * cell_height};
-        Vector2 cell_size = {cell_width, cell_height};
-        Vector2 marker_size = Vector2Scale(cell_size, 0.4);
-        marker_position =
-            Vector2Add(marker_position, Vector2Scale(cell_size, 0.5));
-        marker_position =
-            Vector2Subtract(marker_position, Vector2Scale(marker_size, 0.5));
-        DrawRectangleV(marker_position, marker_size, RED);
-      }
+// The grid goes up as a single-channel texture, one texel per cell, and a
+// single quad draws every marker procedurally, so drawing costs the same
+// however many cells are set.
+//
+// Writers record the columns they changed per row, [dirty_begin, dirty_end),
+// and display_grid uploads only the rectangles around runs of dirty rows.
+// Each row has a single writer, so jobs can mark rows without locking.
+static struct {
+  Texture2D texture;
+  Shader shader;
+  size_t dirty_begin[grid_height];
+  size_t dirty_end[grid_height];
+  size_t upload_bytes; // last display_grid
+  size_t upload_bytes_total;
+} grid_view = {0};
+
+static void mark_grid_row(size_t row, size_t begin, size_t end) {
+  if (begin >= end)
+    return;
+  if (grid_view.dirty_begin[row] >= grid_view.dirty_end[row]) {
+    grid_view.dirty_begin[row] = begin;
+    grid_view.dirty_end[row] = end;
+    return;
+  }
+  if (begin < grid_view.dirty_begin[row])
+    grid_view.dirty_begin[row] = begin;
+  if (end > grid_view.dirty_end[row])
+    grid_view.dirty_end[row] = end;
+}
+
+void mark_grid_dirty(void) {
+  for (size_t row = 0; row < grid_height; ++row)
+    mark_grid_row(row, 0, grid_width);
+}
+
+// Uploads rows [begin, end) between columns [x0, x1)
+static void upload_grid_rect(size_t begin, size_t end, size_t x0,
+                             size_t x1) {
+  size_t w = x1 - x0, h = end - begin;
+  Scratch scratch = scratch_begin(NULL);
+  unsigned char *pixels =
+      arena_alloc_aligned(scratch.arena, w * h, ARENA_REGION_ALIGNMENT);
+  for (size_t row = 0; row < h; ++row)
+    memcpy(pixels + row * w, &grid[begin + row][x0], w);
+  Rectangle rect = {x0, begin, w, h};
+  UpdateTextureRec(grid_view.texture, rect, pixels);
+  scratch_end(scratch);
+  grid_view.upload_bytes += w * h;
+}
+
+static void upload_grid(void) {
+  grid_view.upload_bytes = 0;
+  size_t row = 0;
+  while (row < grid_height) {
+    if (grid_view.dirty_begin[row] >= grid_view.dirty_end[row]) {
+      row++;
+      continue;
     }
+    // Nearby dirty rows share one rectangle as long as it stays within twice
+    // the bytes that actually changed (plus a page), so a moved edge goes up
+    // in a few rectangles without dragging its whole bounding box along
+    size_t begin = row, end = row + 1;
+    size_t x0 = grid_view.dirty_begin[row], x1 = grid_view.dirty_end[row];
+    size_t changed = x1 - x0;
+    grid_view.dirty_begin[row] = grid_view.dirty_end[row] = 0;
+    for (size_t next = row + 1; next < grid_height; ++next) {
+      size_t b = grid_view.dirty_begin[next], e = grid_view.dirty_end[next];
+      if (b >= e)
+        continue;
+      size_t nx0 = b < x0 ? b : x0, nx1 = e > x1 ? e : x1;
+      if ((nx1 - nx0) * (next - begin + 1) > 2 * (changed + e - b) + 4096)
+        break;
+      x0 = nx0;
+      x1 = nx1;
+      changed += e - b;
+      end = next + 1;
+      grid_view.dirty_begin[next] = grid_view.dirty_end[next] = 0;
+    }
+    upload_grid_rect(begin, end, x0, x1);
+    row = end;
+  }
+  grid_view.upload_bytes_total += grid_view.upload_bytes;
+}
+
+static const char *grid_fragment_source =
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "out vec4 finalColor;\n"
+    "void main() {\n"
+    "  vec2 cell = fragTexCoord * vec2(textureSize(texture0, 0));\n"
+    "  vec2 local = abs(fract(cell) - 0.5);\n"
+    "  if (texelFetch(texture0, ivec2(cell), 0).r == 0.0 ||\n"
+    "      max(local.x, local.y) > 0.2) discard;\n"
+    "  finalColor = fragColor;\n"
+    "}\n";
+
+void display_grid(void) {
+  PROFILE_FUNCTION();
+  if (!grid_view.texture.id) {
+    // bool is one byte, the grid uploads as is
+    Image image = {
+        .data = grid,
+        .width = grid_width,
+        .height = grid_height,
+        .mipmaps = 1,
+        .format = PIXELFORMAT_UNCOMPRESSED_GRAYSCALE,
+    };
+    grid_view.texture = LoadTextureFromImage(image);
+    grid_view.shader = LoadShaderFromMemory(NULL, grid_fragment_source);
+    memset(grid_view.dirty_end, 0, sizeof(grid_view.dirty_end));
+    grid_view.upload_bytes = sizeof(grid);
+    grid_view.upload_bytes_total += sizeof(grid);
+  } else {
+    upload_grid();
   }
+
+  Rectangle source = {0, 0, grid_width, grid_height};
+  Rectangle dest = {0, 0, grid_width * cell_width, grid_height * cell_height};
+  BeginShaderMode(grid_view.shader);
+  DrawTexturePro(grid_view.texture, source, dest, (Vector2){0, 0}, 0, RED);
+  EndShaderMode();
+}
+
+void unload_grid_display(void) {
+  if (!grid_view.texture.id)
+    return;
+  UnloadTexture(grid_view.texture);
+  UnloadShader(grid_view.shader);
+  grid_view.texture = (Texture2D){0};
 }
 
 int compare_solutions_by_tx(const void *a, const void *b) {
@@ -79,7 +205,7 @@ int compare_solutions_by_tx(const void *a, const void *b) {
   return 0;
 }
 
-void solve_y_quad(float y, Vector2 p1, Vector2 p2, Vector2 p3,
+void solve_y_quad(Arena *arena, float y, Vector2 p1, Vector2 p2, Vector2 p3,
                   Solutions *solutions) {
   float dx12 = p2.x - p1.x;
   float dx23 = p3.x - p2.x;
@@ -109,11 +235,12 @@ void solve_y_quad(float y, Vector2 p1, Vector2 p2, Vector2 p3,
     float tx = (dx23 - dx12) * t[j] * t[j] + 2 * dx12 * t[j] + p1.x;
     float d = (dy23 - dy12) * t[j] + dy12;
     Solution s = {tx, d};
-    da_append(solutions, s);
+    arena_da_append(arena, solutions, s);
   }
 }
 
-void solve_y_line(float y, Vector2 p1, Vector2 p2, Solutions *solutions) {
+void solve_y_line(Arena *arena, float y, Vector2 p1, Vector2 p2,
+                  Solutions *solutions) {
   float dy = p2.y - p1.y;
   if (fabsf(dy) > 1e-6) {
     float t = (y - p1.y) / dy;
@@ -122,12 +249,14 @@ void solve_y_line(float y, Vector2 p1, Vector2 p2, Solutions *solutions) {
       float tx = dx * t + p1.x;
       float d = dy;
       Solution s = {tx, d};
-      da_append(solutions, s);
+      arena_da_append(arena, solutions, s);
     }
   }
 }
 
-void solve_row(const Spline *spline, size_t row, Solutions *solutions) {
+void solve_row(Arena *arena, const Spline *spline, size_t row,
+               Solutions *solutions) {
+  PROFILE_FUNCTION();
 
   solutions->count = 0;
   float y = (row + 0.5) * cell_height;
@@ -136,10 +265,10 @@ void solve_row(const Spline *spline, size_t row, Solutions *solutions) {
     Segment seg = spline->items[i];
     switch (seg.kind) {
     case SEGMENT_LINE:
-      solve_y_line(y, seg.p1, seg.p2, solutions);
+      solve_y_line(arena, y, seg.p1, seg.p2, solutions);
       break;
     case SEGMENT_QUAD:
-      solve_y_quad(y, seg.p1, seg.p2, seg.p3, solutions);
+      solve_y_quad(arena, y, seg.p1, seg.p2, seg.p3, solutions);
       break;
     default:
       UNREACHABLE("Segment_Kind");
@@ -150,17 +279,21 @@ void solve_row(const Spline *spline, size_t row, Solutions *solutions) {
         compare_solutions_by_tx);
 }
 
-void render_spline_into_grid(const Spline *spline) {
-  static Solutions solutions = {0};
-  for (size_t row = 0; row < grid_height; ++row) {
-    for (size_t col = 0; col < grid_width; ++col) {
-      grid[row][col] = false;
-    }
-  }
+// Rows are independent, each job fills its own rows of the grid. A row is
+// rasterized aside and only the span that differs is written back and
+// marked dirty.
+void render_spline_rows(void *data, size_t begin, size_t end) {
+  const Spline *spline = data;
+  Scratch scratch = scratch_begin(NULL);
+  Solutions solutions = {0};
+  bool *line = arena_alloc_aligned(scratch.arena, grid_width * sizeof(bool),
+                                   ARENA_REGION_ALIGNMENT);
+
+  for (size_t row = begin; row < end; ++row) {
+    memset(line, 0, grid_width * sizeof(bool));
 
-  for (size_t row = 0; row < grid_height; ++row) {
     int winding = 0;
-    solve_row(spline, row, &solutions);
+    solve_row(scratch.arena, spline, row, &solutions);
     for (size_t i = 0; i < solutions.count; ++i) {
       Solution s = solutions.items[i];
       if (winding > 0) {
@@ -180,7 +313,7 @@ void render_spline_into_grid(const Spline *spline) {
             col2 = grid_width - 1;
 
           for (size_t col = col1; col <= col2; ++col) {
-            grid[row][col] = true;
+            line[col] = true;
           }
         }
       }
@@ -190,7 +323,21 @@ void render_spline_into_grid(const Spline *spline) {
         winding -= 1;
       }
     }
+
+    size_t first = 0, last = grid_width;
+    while (first < last && grid[row][first] == line[first])
+      first++;
+    while (last > first && grid[row][last - 1] == line[last - 1])
+      last--;
+    memcpy(&grid[row][first], &line[first], last - first);
+    mark_grid_row(row, first, last);
   }
+  scratch_end(scratch);
+}
+
+void render_spline_into_grid(const Spline *spline) {
+  PROFILE_FUNCTION();
+  parallel_for(render_spline_rows, (void *)spline, grid_height, 4);
 }
 
 typedef struct {
@@ -200,9 +347,11 @@ typedef struct {
   int dragging;
 } Control_Points;
 
-void control_points_to_spline(const Control_Points *control_points,
+// The spline is rebuilt from scratch into `arena`, usually the frame arena.
+void control_points_to_spline(Arena *arena,
+                              const Control_Points *control_points,
                               Spline *spline) {
-  spline->count = 0;
+  *spline = (Spline){0};
   if (control_points->count <= 2)
     return;
 
@@ -216,7 +365,7 @@ void control_points_to_spline(const Control_Points *control_points,
         .p2 = p2,
         .p3 = p3,
     };
-    da_append(spline, seg);
+    arena_da_append(arena, spline, seg);
   }
 
   if (control_points->count % 2 == 1) {
@@ -227,12 +376,17 @@ void control_points_to_spline(const Control_Points *control_points,
         .p1 = p1,
         .p2 = p2,
     };
-    da_append(spline, seg);
+    arena_da_append(arena, spline, seg);
   }
 }
 
-void edit_control_points(Control_Points *control_points, Spline *spline) {
-  Vector2 mouse = GetMousePosition();
+// True when the spline was rebuilt and needs filling again
+bool edit_control_points(Arena *frame_arena, const InputState *input,
+                         Control_Points *control_points, Spline *spline) {
+  bool changed = false;
+  Vector2 mouse = {input->mouse_x, input->mouse_y};
+  bool pressed = input->buttons_pressed & (1u << MOUSE_LEFT_BUTTON);
+  bool released = input->buttons_released & (1u << MOUSE_LEFT_BUTTON);
 
   for (size_t i = 0; i < control_points->count; ++i) {
     Vector2 size = {20, 20};
@@ -243,10 +397,10 @@ void edit_control_points(Control_Points *control_points, Spline *spline) {
         mouse, (Rectangle){position.x, position.y, size.x, size.y});
 
     if (hover) {
-      if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+      if (pressed)
         control_points->dragging = i;
     } else {
-      if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON))
+      if (released)
         control_points->dragging = -1;
     }
     DrawRectangleV(position, size, hover ? RED : BLUE);
@@ -255,13 +409,14 @@ void edit_control_points(Control_Points *control_points, Spline *spline) {
   if (control_points->dragging >= 0) {
     if (control_points->items[control_points->dragging].x != mouse.x ||
         control_points->items[control_points->dragging].y != mouse.y) {
-      control_points_to_spline(control_points, spline);
-      render_spline_into_grid(spline);
+      control_points_to_spline(frame_arena, control_points, spline);
+      changed = true;
     }
     control_points->items[control_points->dragging] = mouse;
   } else {
-    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+    if (pressed) {
       da_append(control_points, mouse);
     }
   }
+  return changed;
 }
@@ -39,22 +39,74 @@
 #define ARENA_BACKEND_LINUX_MMAP 1
 #define ARENA_BACKEND_WIN32_VIRTUALALLOC 2
 #define ARENA_BACKEND_WASM_HEAPBASE 3
+#define ARENA_BACKEND_LINUX_VMEM 4
 
 #ifndef ARENA_BACKEND
 #define ARENA_BACKEND ARENA_BACKEND_LIBC_MALLOC
 #endif // ARENA_BACKEND
 
+// Every backend returns regions aligned to ARENA_REGION_ALIGNMENT and the
+// header is padded to it, so data[] starts cache line aligned and aligned
+// allocations at the start of a region need no padding.
+#ifndef ARENA_REGION_ALIGNMENT
+#define ARENA_REGION_ALIGNMENT 64
+#endif // ARENA_REGION_ALIGNMENT
+
+#ifdef __cplusplus
+#define ARENA_ALIGNAS(n) alignas(n)
+#else
+#define ARENA_ALIGNAS(n) _Alignas(n)
+#endif
+
 typedef struct Arena_Region Arena_Region;
 
 struct Arena_Region {
   Arena_Region *next;
   size_t count;
   size_t capacity;
-  uintptr_t data[];
+#if ARENA_BACKEND == ARENA_BACKEND_LINUX_VMEM
+  size_t committed; // words of data[] backed by read/write pages
+#endif
+  ARENA_ALIGNAS(ARENA_REGION_ALIGNMENT) uintptr_t data[];
 };
 
+// Define ARENA_STATS to have every arena collect usage statistics, see
+// arena_stats_report(). Without it the stats hooks compile to nothing.
+#ifndef ARENA_STATS_MAX_TAGS
+#define ARENA_STATS_MAX_TAGS 16
+#endif // ARENA_STATS_MAX_TAGS
+
+typedef struct {
+  const char *name;
+  size_t allocations;
+  size_t bytes;
+} Arena_Stats_Tag;
+
+typedef struct {
+  size_t allocations;
+  size_t bytes_requested; // as passed to arena_alloc
+  size_t bytes_used;      // currently allocated, word rounded
+  size_t high_water;      // max of bytes_used
+  size_t regions;         // new_region calls
+  size_t regions_skipped; // existing regions too full for an allocation
+  size_t oversized;       // allocations above ARENA_REGION_DEFAULT_CAPACITY
+  size_t wasted_tail;     // bytes left at the end of skipped regions
+  size_t padding;         // bytes skipped to align allocations
+  size_t realloc_in_place;
+  size_t realloc_copies;
+  size_t realloc_copy_bytes;
+  size_t resets;
+
+  const char *tag; // current tag, allocations are charged to it
+  Arena_Stats_Tag tags[ARENA_STATS_MAX_TAGS];
+  size_t tags_count;
+} Arena_Stats;
+
 typedef struct {
   Arena_Region *begin, *end;
+#ifdef ARENA_STATS
+  Arena_Stats stats;
+#endif // ARENA_STATS
 } Arena;
 
 typedef struct {
@@ -66,11 +118,35 @@ typedef struct {
 #define ARENA_REGION_DEFAULT_CAPACITY (8 * 1024)
 #endif // ARENA_REGION_DEFAULT_CAPACITY
 
+// ARENA_BACKEND_LINUX_VMEM reserves one large virtual range per region up
+// front and commits it in ARENA_VMEM_COMMIT_SIZE steps as the arena grows, so
+// a region serves most arenas whole and its last allocation can grow in
+// place; past the reservation the arena chains regions as usual. Under an
+// address space limit (ulimit -v) a reservation that fails is retried at half
+// the size, down to what the allocation needs. Define ARENA_VMEM_HUGEPAGES to
+// madvise(MADV_HUGEPAGE) it.
+#ifndef ARENA_VMEM_RESERVE_SIZE
+#define ARENA_VMEM_RESERVE_SIZE ((size_t)256 << 20)
+#endif // ARENA_VMEM_RESERVE_SIZE
+
+#ifndef ARENA_VMEM_COMMIT_SIZE
+#ifdef ARENA_VMEM_HUGEPAGES
+#define ARENA_VMEM_COMMIT_SIZE ((size_t)2 << 20)
+#else
+#define ARENA_VMEM_COMMIT_SIZE ((size_t)64 << 10)
+#endif
+#endif // ARENA_VMEM_COMMIT_SIZE
+
 Arena_Region *new_region(size_t capacity);
 void free_region(Arena_Region *r);
 
 void *arena_alloc(Arena *a, size_t size_bytes);
 void *arena_realloc(Arena *a, void *oldptr, size_t oldsz, size_t newsz);
+// `alignment` is a power of two, anything below sizeof(uintptr_t) is rounded
+// up to it (which is what arena_alloc/arena_realloc use).
+void *arena_alloc_aligned(Arena *a, size_t size_bytes, size_t alignment);
+void *arena_realloc_aligned(Arena *a, void *oldptr, size_t oldsz, size_t newsz,
+                            size_t alignment);
 char *arena_strdup(Arena *a, const char *cstr);
 void *arena_memdup(Arena *a, void *data, size_t size);
 #ifndef ARENA_NOSTDIO
@@ -83,6 +159,37 @@ void arena_rewind(Arena *a, Arena_Mark m);
 void arena_free(Arena *a);
 void arena_trim(Arena *a);
 
+#ifdef ARENA_STATS
+void arena_stats_tag(Arena *a, const char *tag);
+size_t arena_stats_committed(const Arena *a);
+#ifndef ARENA_NOSTDIO
+void arena_stats_report(const Arena *a, const char *name, FILE *stream);
+#endif // ARENA_NOSTDIO
+#define ARENA_STATS_TAG(a, tag) arena_stats_tag((a), (tag))
+#define ARENA_STATS_REPORT(a, name, stream)                                    \
+  arena_stats_report((a), (name), (stream))
+#else
+#define ARENA_STATS_TAG(a, tag) ((void)0)
+#define ARENA_STATS_REPORT(a, name, stream) ((void)0)
+#endif // ARENA_STATS
+
+// Define ARENA_CONCURRENT for Arena_Concurrent, an arena that many threads
+// can allocate from at once (GCC/Clang atomics). Allocation is a single
+// atomic fetch-add on the current region's count; only moving on to the next
+// region takes a spinlock. arena_concurrent_reset/free have the same meaning
+// as arena_reset/arena_free and must not race with allocations. There is no
+// snapshot/rewind, allocations of different threads interleave.
+#ifdef ARENA_CONCURRENT
+typedef struct {
+  Arena_Region *begin, *end;
+  char lock;
+} Arena_Concurrent;
+
+void *arena_concurrent_alloc(Arena_Concurrent *a, size_t size_bytes);
+void arena_concurrent_reset(Arena_Concurrent *a);
+void arena_concurrent_free(Arena_Concurrent *a);
+#endif // ARENA_CONCURRENT
+
 #ifndef ARENA_DA_INIT_CAP
 #define ARENA_DA_INIT_CAP 256
 #endif // ARENA_DA_INIT_CAP
@@ -94,13 +201,17 @@ void arena_trim(Arena *a);
 #endif
 
 #define arena_da_append(a, da, item)                                           \
+  arena_da_append_aligned(a, da, item, sizeof(uintptr_t))
+
+// Append to a dynamic array whose items buffer is kept `alignment` aligned
+#define arena_da_append_aligned(a, da, item, alignment)                        \
   do {                                                                         \
     if ((da)->count >= (da)->capacity) {                                       \
       size_t new_capacity =                                                    \
           (da)->capacity == 0 ? ARENA_DA_INIT_CAP : (da)->capacity * 2;        \
-      (da)->items = cast_ptr((da)->items) arena_realloc(                       \
+      (da)->items = cast_ptr((da)->items) arena_realloc_aligned(               \
           (a), (da)->items, (da)->capacity * sizeof(*(da)->items),             \
-          new_capacity * sizeof(*(da)->items));                                \
+          new_capacity * sizeof(*(da)->items), (alignment));                   \
       (da)->capacity = new_capacity;                                           \
     }                                                                          \
                                                                                \
@@ -109,6 +220,11 @@ void arena_trim(Arena *a);
 
 // Append several items to a dynamic array
 #define arena_da_append_many(a, da, new_items, new_items_count)                \
+  arena_da_append_many_aligned(a, da, new_items, new_items_count,              \
+                               sizeof(uintptr_t))
+
+#define arena_da_append_many_aligned(a, da, new_items, new_items_count,        \
+                                     alignment)                                \
   do {                                                                         \
     if ((da)->count + (new_items_count) > (da)->capacity) {                    \
       size_t new_capacity = (da)->capacity;                                    \
@@ -116,9 +232,9 @@ void arena_trim(Arena *a);
         new_capacity = ARENA_DA_INIT_CAP;                                      \
       while ((da)->count + (new_items_count) > new_capacity)                   \
         new_capacity *= 2;                                                     \
-      (da)->items = cast_ptr((da)->items) arena_realloc(                       \
+      (da)->items = cast_ptr((da)->items) arena_realloc_aligned(               \
           (a), (da)->items, (da)->capacity * sizeof(*(da)->items),             \
-          new_capacity * sizeof(*(da)->items));                                \
+          new_capacity * sizeof(*(da)->items), (alignment));                   \
       (da)->capacity = new_capacity;                                           \
     }                                                                          \
     arena_memcpy((da)->items + (da)->count, (new_items),                       \
@@ -155,7 +271,15 @@ Arena_Region *new_region(size_t capacity) {
   size_t size_bytes = sizeof(Arena_Region) + sizeof(uintptr_t) * capacity;
   // TODO: it would be nice if we could guarantee that the regions are allocated
   // by ARENA_BACKEND_LIBC_MALLOC are page aligned
-  Arena_Region *r = (Arena_Region *)malloc(size_bytes);
+  size_bytes = (size_bytes + ARENA_REGION_ALIGNMENT - 1) /
+               ARENA_REGION_ALIGNMENT * ARENA_REGION_ALIGNMENT;
+#ifdef _WIN32
+  Arena_Region *r =
+      (Arena_Region *)_aligned_malloc(size_bytes, ARENA_REGION_ALIGNMENT);
+#else
+  Arena_Region *r =
+      (Arena_Region *)aligned_alloc(ARENA_REGION_ALIGNMENT, size_bytes);
+#endif
   ARENA_ASSERT(r); // TODO: since ARENA_ASSERT is disableable go through all the
                    // places where we use it to check for failed memory
                    // allocation and return with NULL there.
@@ -165,7 +289,11 @@ Arena_Region *new_region(size_t capacity) {
   return r;
 }
 
+#ifdef _WIN32
+void free_region(Arena_Region *r) { _aligned_free(r); }
+#else
 void free_region(Arena_Region *r) { free(r); }
+#endif
 #elif ARENA_BACKEND == ARENA_BACKEND_LINUX_MMAP
 #include <sys/mman.h>
 #include <unistd.h>
@@ -187,6 +315,75 @@ void free_region(Arena_Region *r) {
   ARENA_ASSERT(ret == 0);
 }
 
+#elif ARENA_BACKEND == ARENA_BACKEND_LINUX_VMEM
+#include <sys/mman.h>
+#include <unistd.h>
+
+static size_t arena_vmem_round(size_t size_bytes, size_t granularity) {
+  return (size_bytes + granularity - 1) / granularity * granularity;
+}
+
+Arena_Region *new_region(size_t capacity) {
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t min_bytes = arena_vmem_round(
+      sizeof(Arena_Region) + sizeof(uintptr_t) * capacity, page);
+  size_t size_bytes = min_bytes;
+  if (size_bytes < ARENA_VMEM_RESERVE_SIZE)
+    size_bytes = arena_vmem_round(ARENA_VMEM_RESERVE_SIZE, page);
+
+  Arena_Region *r;
+  for (;;) {
+    r = mmap(NULL, size_bytes, PROT_NONE,
+             MAP_ANONYMOUS | MAP_PRIVATE | MAP_NORESERVE, -1, 0);
+    if (r != MAP_FAILED || size_bytes == min_bytes)
+      break;
+    size_bytes = arena_vmem_round(size_bytes / 2, page);
+    if (size_bytes < min_bytes)
+      size_bytes = min_bytes;
+  }
+  ARENA_ASSERT(r != MAP_FAILED);
+#ifdef ARENA_VMEM_HUGEPAGES
+  madvise(r, size_bytes, MADV_HUGEPAGE);
+#endif
+
+  size_t commit_bytes = arena_vmem_round(
+      sizeof(Arena_Region) + sizeof(uintptr_t) * ARENA_REGION_DEFAULT_CAPACITY,
+      ARENA_VMEM_COMMIT_SIZE);
+  if (commit_bytes > size_bytes)
+    commit_bytes = size_bytes;
+  int ret = mprotect(r, commit_bytes, PROT_READ | PROT_WRITE);
+  ARENA_ASSERT(ret == 0);
+
+  r->next = NULL;
+  r->count = 0;
+  r->capacity = (size_bytes - sizeof(Arena_Region)) / sizeof(uintptr_t);
+  r->committed = (commit_bytes - sizeof(Arena_Region)) / sizeof(uintptr_t);
+  return r;
+}
+
+void free_region(Arena_Region *r) {
+  size_t size_bytes = sizeof(Arena_Region) + sizeof(uintptr_t) * r->capacity;
+  int ret = munmap(r, size_bytes);
+  ARENA_ASSERT(ret == 0);
+}
+
+// Makes sure the first `count` words of the region are usable.
+static void region_commit(Arena_Region *r, size_t count) {
+  if (count <= r->committed)
+    return;
+  size_t begin = sizeof(Arena_Region) + sizeof(uintptr_t) * r->committed;
+  size_t end = sizeof(Arena_Region) + sizeof(uintptr_t) * count;
+  end = arena_vmem_round(end, ARENA_VMEM_COMMIT_SIZE);
+  size_t limit = sizeof(Arena_Region) + sizeof(uintptr_t) * r->capacity;
+  if (end > limit)
+    end = limit;
+  int ret = mprotect((char *)r + begin, end - begin, PROT_READ | PROT_WRITE);
+  ARENA_ASSERT(ret == 0);
+  // Atomic for the lock-free committed check in arena_concurrent_alloc
+  size_t committed = (end - sizeof(Arena_Region)) / sizeof(uintptr_t);
+  __atomic_store_n(&r->committed, committed, __ATOMIC_RELEASE);
+}
+
 #elif ARENA_BACKEND == ARENA_BACKEND_WIN32_VIRTUALALLOC
 
 #if !defined(_WIN32)
@@ -248,6 +445,9 @@ unsigned char *bump_pointer = &__heap_base;
 
 Arena_Region *new_region(size_t capacity) {
   size_t size_bytes = sizeof(Arena_Region) + sizeof(uintptr_t) * capacity;
+  bump_pointer = (unsigned char *)(((uintptr_t)bump_pointer +
+                                    ARENA_REGION_ALIGNMENT - 1) &
+                                   ~(uintptr_t)(ARENA_REGION_ALIGNMENT - 1));
   Arena_Region *r = (void *)bump_pointer;
 
   // grow memory brk() style
@@ -284,54 +484,191 @@ void free_region(Arena_Region *r) {
 #error "Unknown Arena backend"
 #endif
 
-// TODO: add debug statistic collection mode for arena
-// Should collect things like:
-// - How many times new_region was called
-// - How many times existing region was skipped
-// - How many times allocation exceeded ARENA_REGION_DEFAULT_CAPACITY
+#if ARENA_BACKEND == ARENA_BACKEND_LINUX_VMEM
+#define ARENA_REGION_COMMIT(r, count) region_commit((r), (count))
+#else
+#define ARENA_REGION_COMMIT(r, count) ((void)0)
+#endif
 
-void *arena_alloc(Arena *a, size_t size_bytes) {
+#ifdef ARENA_STATS
+#define ARENA_STATS_ADD(a, field, n) ((a)->stats.field += (n))
+
+// Charges `size_bytes` requested / `size` words to the arena and its current
+// tag. In place growth is charged with `allocations` 0.
+static void arena_stats_charge(Arena *a, size_t size_bytes, size_t size,
+                               size_t allocations) {
+  Arena_Stats *st = &a->stats;
+  st->allocations += allocations;
+  st->bytes_requested += size_bytes;
+  st->bytes_used += size * sizeof(uintptr_t);
+  if (st->bytes_used > st->high_water)
+    st->high_water = st->bytes_used;
+
+  if (st->tag == NULL)
+    return;
+  for (size_t i = 0; i < st->tags_count; ++i) {
+    if (st->tags[i].name == st->tag) {
+      st->tags[i].allocations += allocations;
+      st->tags[i].bytes += size_bytes;
+      return;
+    }
+  }
+  if (st->tags_count < ARENA_STATS_MAX_TAGS) {
+    Arena_Stats_Tag t = {st->tag, allocations, size_bytes};
+    st->tags[st->tags_count++] = t;
+  }
+}
+
+// Tags are compared by pointer, pass string literals. NULL stops tagging.
+void arena_stats_tag(Arena *a, const char *tag) { a->stats.tag = tag; }
+
+size_t arena_stats_committed(const Arena *a) {
+  size_t bytes = 0;
+  for (Arena_Region *r = a->begin; r != NULL; r = r->next) {
+#if ARENA_BACKEND == ARENA_BACKEND_LINUX_VMEM
+    bytes += sizeof(Arena_Region) + sizeof(uintptr_t) * r->committed;
+#else
+    bytes += sizeof(Arena_Region) + sizeof(uintptr_t) * r->capacity;
+#endif
+  }
+  return bytes;
+}
+
+#ifndef ARENA_NOSTDIO
+void arena_stats_report(const Arena *a, const char *name, FILE *stream) {
+  const Arena_Stats *st = &a->stats;
+  fprintf(stream, "arena %s:\n", name);
+  fprintf(stream, "  allocations      %zu (%zu oversized)\n", st->allocations,
+          st->oversized);
+  fprintf(stream, "  requested        %zu bytes\n", st->bytes_requested);
+  fprintf(stream, "  in use           %zu bytes (high water %zu)\n",
+          st->bytes_used, st->high_water);
+  fprintf(stream, "  committed        %zu bytes\n", arena_stats_committed(a));
+  fprintf(stream, "  regions          %zu new, %zu skipped, %zu bytes wasted\n",
+          st->regions, st->regions_skipped, st->wasted_tail);
+  fprintf(stream, "  padding          %zu bytes\n", st->padding);
+  fprintf(stream, "  realloc          %zu in place, %zu copies (%zu bytes)\n",
+          st->realloc_in_place, st->realloc_copies, st->realloc_copy_bytes);
+  fprintf(stream, "  resets           %zu\n", st->resets);
+  for (size_t i = 0; i < st->tags_count; ++i) {
+    fprintf(stream, "  [%s] %zu allocations, %zu bytes\n", st->tags[i].name,
+            st->tags[i].allocations, st->tags[i].bytes);
+  }
+}
+#endif // ARENA_NOSTDIO
+#else
+#define ARENA_STATS_ADD(a, field, n) ((void)0)
+#endif // ARENA_STATS
+
+// Words to skip so that the next allocation in `r` is `alignment` aligned
+static size_t arena_padding(const Arena_Region *r, size_t alignment) {
+  uintptr_t p = (uintptr_t)&r->data[r->count];
+  return ((alignment - (p & (alignment - 1))) & (alignment - 1)) /
+         sizeof(uintptr_t);
+}
+
+void *arena_alloc_aligned(Arena *a, size_t size_bytes, size_t alignment) {
   size_t size = (size_bytes + sizeof(uintptr_t) - 1) / sizeof(uintptr_t);
+  if (alignment < sizeof(uintptr_t))
+    alignment = sizeof(uintptr_t);
+  ARENA_ASSERT((alignment & (alignment - 1)) == 0);
+
+  // data[] of a fresh region is ARENA_REGION_ALIGNMENT aligned, only larger
+  // alignments may need padding there
+  size_t region_size = size;
+  if (alignment > ARENA_REGION_ALIGNMENT)
+    region_size += (alignment - ARENA_REGION_ALIGNMENT) / sizeof(uintptr_t);
 
   if (a->end == NULL) {
     ARENA_ASSERT(a->begin == NULL);
     size_t capacity = ARENA_REGION_DEFAULT_CAPACITY;
-    if (capacity < size)
-      capacity = size;
+    if (capacity < region_size)
+      capacity = region_size;
     a->end = new_region(capacity);
     a->begin = a->end;
+    ARENA_STATS_ADD(a, regions, 1);
   }
 
-  while (a->end->count + size > a->end->capacity && a->end->next != NULL) {
+  size_t padding = arena_padding(a->end, alignment);
+  while (a->end->count + padding + size > a->end->capacity &&
+         a->end->next != NULL) {
+    ARENA_STATS_ADD(a, regions_skipped, 1);
+    ARENA_STATS_ADD(a, wasted_tail,
+                    (a->end->capacity - a->end->count) * sizeof(uintptr_t));
     a->end = a->end->next;
+    padding = arena_padding(a->end, alignment);
   }
 
-  if (a->end->count + size > a->end->capacity) {
+  if (a->end->count + padding + size > a->end->capacity) {
     ARENA_ASSERT(a->end->next == NULL);
     size_t capacity = ARENA_REGION_DEFAULT_CAPACITY;
-    if (capacity < size)
-      capacity = size;
+    if (capacity < region_size)
+      capacity = region_size;
+    ARENA_STATS_ADD(a, regions_skipped, 1);
+    ARENA_STATS_ADD(a, wasted_tail,
+                    (a->end->capacity - a->end->count) * sizeof(uintptr_t));
     a->end->next = new_region(capacity);
     a->end = a->end->next;
+    ARENA_STATS_ADD(a, regions, 1);
+    padding = arena_padding(a->end, alignment);
   }
 
+  a->end->count += padding;
+  ARENA_STATS_ADD(a, padding, padding * sizeof(uintptr_t));
+  ARENA_REGION_COMMIT(a->end, a->end->count + size);
   void *result = &a->end->data[a->end->count];
   a->end->count += size;
+#ifdef ARENA_STATS
+  if (size > ARENA_REGION_DEFAULT_CAPACITY)
+    a->stats.oversized += 1;
+  arena_stats_charge(a, size_bytes, size + padding, 1);
+#endif // ARENA_STATS
   return result;
 }
 
-void *arena_realloc(Arena *a, void *oldptr, size_t oldsz, size_t newsz) {
+void *arena_alloc(Arena *a, size_t size_bytes) {
+  return arena_alloc_aligned(a, size_bytes, sizeof(uintptr_t));
+}
+
+void *arena_realloc_aligned(Arena *a, void *oldptr, size_t oldsz, size_t newsz,
+                            size_t alignment) {
   if (newsz <= oldsz)
     return oldptr;
-  void *newptr = arena_alloc(a, newsz);
-  char *newptr_char = (char *)newptr;
-  char *oldptr_char = (char *)oldptr;
-  for (size_t i = 0; i < oldsz; ++i) {
-    newptr_char[i] = oldptr_char[i];
+
+  size_t old_size = (oldsz + sizeof(uintptr_t) - 1) / sizeof(uintptr_t);
+  size_t new_size = (newsz + sizeof(uintptr_t) - 1) / sizeof(uintptr_t);
+
+  // The last allocation of the current region just moves the bump pointer
+  if (oldptr != NULL && a->end != NULL &&
+      (uintptr_t *)oldptr + old_size == &a->end->data[a->end->count] &&
+      a->end->count - old_size + new_size <= a->end->capacity) {
+    ARENA_REGION_COMMIT(a->end, a->end->count - old_size + new_size);
+    a->end->count = a->end->count - old_size + new_size;
+    ARENA_STATS_ADD(a, realloc_in_place, 1);
+#ifdef ARENA_STATS
+    arena_stats_charge(a, newsz - oldsz, new_size - old_size, 0);
+#endif // ARENA_STATS
+    return oldptr;
+  }
+
+  if (old_size > 0) {
+    ARENA_STATS_ADD(a, realloc_copies, 1);
+    ARENA_STATS_ADD(a, realloc_copy_bytes, old_size * sizeof(uintptr_t));
+  }
+
+  // Allocations are word sized and word aligned, so copy whole words
+  uintptr_t *newptr = (uintptr_t *)arena_alloc_aligned(a, newsz, alignment);
+  uintptr_t *oldptr_word = (uintptr_t *)oldptr;
+  for (size_t i = 0; i < old_size; ++i) {
+    newptr[i] = oldptr_word[i];
   }
   return newptr;
 }
 
+void *arena_realloc(Arena *a, void *oldptr, size_t oldsz, size_t newsz) {
+  return arena_realloc_aligned(a, oldptr, oldsz, newsz, sizeof(uintptr_t));
+}
+
 size_t arena_strlen(const char *s) {
   size_t n = 0;
   while (*s++)
@@ -396,6 +733,10 @@ void arena_reset(Arena *a) {
   }
 
   a->end = a->begin;
+  ARENA_STATS_ADD(a, resets, 1);
+#ifdef ARENA_STATS
+  a->stats.bytes_used = 0;
+#endif // ARENA_STATS
 }
 
 void arena_rewind(Arena *a, Arena_Mark m) {
@@ -410,6 +751,12 @@ void arena_rewind(Arena *a, Arena_Mark m) {
   }
 
   a->end = m.region;
+#ifdef ARENA_STATS
+  a->stats.bytes_used = 0;
+  for (Arena_Region *r = a->begin; r != NULL; r = r->next) {
+    a->stats.bytes_used += r->count * sizeof(uintptr_t);
+  }
+#endif // ARENA_STATS
 }
 
 void arena_free(Arena *a) {
@@ -421,6 +768,9 @@ void arena_free(Arena *a) {
   }
   a->begin = NULL;
   a->end = NULL;
+#ifdef ARENA_STATS
+  a->stats.bytes_used = 0;
+#endif // ARENA_STATS
 }
 
 void arena_trim(Arena *a) {
@@ -433,4 +783,88 @@ void arena_trim(Arena *a) {
   a->end->next = NULL;
 }
 
+#ifdef ARENA_CONCURRENT
+static void arena_concurrent_lock(Arena_Concurrent *a) {
+  while (__atomic_test_and_set(&a->lock, __ATOMIC_ACQUIRE)) {
+    while (__atomic_load_n(&a->lock, __ATOMIC_RELAXED)) {
+    }
+  }
+}
+
+static void arena_concurrent_unlock(Arena_Concurrent *a) {
+  __atomic_clear(&a->lock, __ATOMIC_RELEASE);
+}
+
+// Slow path: `full` could not fit `size` words. Unless another thread already
+// moved the arena on, advance to the next region, chaining a new one at the
+// tail if there is none left.
+static void arena_concurrent_grow(Arena_Concurrent *a, Arena_Region *full,
+                                  size_t size) {
+  arena_concurrent_lock(a);
+  if (a->end == full) {
+    Arena_Region *next = full != NULL ? full->next : NULL;
+    while (next != NULL && next->capacity < size)
+      next = next->next;
+
+    if (next == NULL) {
+      size_t capacity = ARENA_REGION_DEFAULT_CAPACITY;
+      if (capacity < size)
+        capacity = size;
+      next = new_region(capacity);
+      if (a->begin == NULL) {
+        a->begin = next;
+      } else {
+        Arena_Region *tail = full;
+        while (tail->next != NULL)
+          tail = tail->next;
+        tail->next = next;
+      }
+    }
+    __atomic_store_n(&a->end, next, __ATOMIC_RELEASE);
+  }
+  arena_concurrent_unlock(a);
+}
+
+void *arena_concurrent_alloc(Arena_Concurrent *a, size_t size_bytes) {
+  size_t size = (size_bytes + sizeof(uintptr_t) - 1) / sizeof(uintptr_t);
+
+  for (;;) {
+    Arena_Region *r = __atomic_load_n(&a->end, __ATOMIC_ACQUIRE);
+    if (r != NULL) {
+      // Failed attempts leave count past capacity, which just reads as full
+      size_t count = __atomic_fetch_add(&r->count, size, __ATOMIC_RELAXED);
+      if (count + size <= r->capacity) {
+#if ARENA_BACKEND == ARENA_BACKEND_LINUX_VMEM
+        if (count + size > __atomic_load_n(&r->committed, __ATOMIC_ACQUIRE)) {
+          arena_concurrent_lock(a);
+          region_commit(r, count + size);
+          arena_concurrent_unlock(a);
+        }
+#endif
+        return &r->data[count];
+      }
+    }
+    arena_concurrent_grow(a, r, size);
+  }
+}
+
+void arena_concurrent_reset(Arena_Concurrent *a) {
+  for (Arena_Region *r = a->begin; r != NULL; r = r->next) {
+    r->count = 0;
+  }
+  a->end = a->begin;
+}
+
+void arena_concurrent_free(Arena_Concurrent *a) {
+  Arena_Region *r = a->begin;
+  while (r) {
+    Arena_Region *r0 = r;
+    r = r->next;
+    free_region(r0);
+  }
+  a->begin = NULL;
+  a->end = NULL;
+}
+#endif // ARENA_CONCURRENT
+
 #endif // ARENA_IMPLEMENTATION
@@ -0,0 +1,309 @@
+#include "assets.h"
+#include "../profiler/profiler.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+  Asset **items;
+  size_t count;
+  size_t capacity;
+} AssetList;
+
+static struct {
+  Arena arena; // pool slabs and the live list
+  Pool pool;
+  AssetList live;
+  size_t in_flight; // main thread only
+
+  pthread_t io[ASSETS_IO_THREADS];
+  int io_count;
+  bool quit;
+
+  // Guards both queues
+  pthread_mutex_t lock;
+  pthread_cond_t io_wake;
+  pthread_cond_t done_wake;
+  Asset *io_head, *io_tail;
+  Asset *done_head, *done_tail;
+
+  JobCounter decoding;
+  Pack pack;
+  AssetWakeFunc *wake;
+} assets = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .io_wake = PTHREAD_COND_INITIALIZER,
+    .done_wake = PTHREAD_COND_INITIALIZER,
+};
+
+static double assets_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void assets_set_state(Asset *asset, AssetState state) {
+  __atomic_store_n(&asset->state, (int)state, __ATOMIC_RELEASE);
+}
+
+static void assets_push(Asset **head, Asset **tail, Asset *asset) {
+  asset->next = NULL;
+  if (*tail)
+    (*tail)->next = asset;
+  else
+    *head = asset;
+  *tail = asset;
+}
+
+static Asset *assets_pop(Asset **head, Asset **tail) {
+  Asset *asset = *head;
+  if (asset) {
+    *head = asset->next;
+    if (!*head)
+      *tail = NULL;
+  }
+  return asset;
+}
+
+// Hands the asset to the main loop
+static void assets_complete(Asset *asset, bool ok) {
+  assets_set_state(asset, ok ? ASSET_UPLOADING : ASSET_FAILED);
+  pthread_mutex_lock(&assets.lock);
+  assets_push(&assets.done_head, &assets.done_tail, asset);
+  pthread_cond_signal(&assets.done_wake);
+  pthread_mutex_unlock(&assets.lock);
+  if (assets.wake)
+    assets.wake();
+}
+
+static void assets_decode_job(void *data, size_t begin, size_t end) {
+  (void)begin;
+  (void)end;
+  PROFILE_ZONE("asset_decode");
+  Asset *asset = (Asset *)data;
+  if (!asset->data) {
+    asset->data = pack_data(&assets.pack, asset->packed, &asset->arena);
+    if (!asset->data) {
+      fprintf(stderr, "Corrupt pack entry `%s`\n", asset->path);
+      assets_complete(asset, false);
+      return;
+    }
+  }
+  assets_complete(asset, !asset->decode || asset->decode(asset));
+}
+
+static bool assets_read(Asset *asset) {
+  PROFILE_ZONE("asset_read");
+  int fd = open(asset->path, O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "Could not open asset `%s`\n", asset->path);
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+
+  size_t size = (size_t)st.st_size;
+  unsigned char *data = (unsigned char *)arena_alloc_aligned(
+      &asset->arena, size, ARENA_REGION_ALIGNMENT);
+  asset->data = data;
+  size_t done = 0;
+  while (done < size) {
+    size_t chunk = size - done;
+    if (chunk > ASSETS_READ_CHUNK)
+      chunk = ASSETS_READ_CHUNK;
+    ssize_t n = pread(fd, data + done, chunk, (off_t)done);
+    if (n <= 0) {
+      fprintf(stderr, "Could not read asset `%s`\n", asset->path);
+      close(fd);
+      return false;
+    }
+    done += (size_t)n;
+  }
+  close(fd);
+  asset->size = size;
+  return true;
+}
+
+static void *assets_io_main(void *arg) {
+  (void)arg;
+  PROFILE_THREAD_NAME("io");
+  for (;;) {
+    pthread_mutex_lock(&assets.lock);
+    while (!assets.quit && !assets.io_head)
+      pthread_cond_wait(&assets.io_wake, &assets.lock);
+    Asset *asset = assets.quit
+                       ? NULL
+                       : assets_pop(&assets.io_head, &assets.io_tail);
+    pthread_mutex_unlock(&assets.lock);
+    if (!asset)
+      return NULL;
+
+    assets_set_state(asset, ASSET_LOADING);
+    bool ok = assets_read(asset);
+    if (ok && asset->decode) {
+      jobs_run(assets_decode_job, asset, 1, &assets.decoding);
+    } else {
+      assets_complete(asset, ok);
+    }
+  }
+}
+
+bool assets_init(void) {
+  pool_init_typed(&assets.pool, &assets.arena, Asset, POOL_HANDLES);
+  assets.quit = false;
+  for (int i = 0; i < ASSETS_IO_THREADS; ++i) {
+    if (pthread_create(&assets.io[i], NULL, assets_io_main, NULL) != 0) {
+      fprintf(stderr, "Could not start asset IO thread %d\n", i);
+      break;
+    }
+    assets.io_count++;
+  }
+  return assets.io_count > 0;
+}
+
+void assets_set_wake(AssetWakeFunc *wake) { assets.wake = wake; }
+
+bool assets_mount(const char *packPath) {
+  pack_close(&assets.pack);
+  return pack_open(&assets.pack, packPath);
+}
+
+static void assets_free(Asset *asset) {
+  for (size_t i = 0; i < assets.live.count; ++i) {
+    if (assets.live.items[i] == asset) {
+      assets.live.items[i] = assets.live.items[--assets.live.count];
+      break;
+    }
+  }
+  arena_free(&asset->arena);
+  pool_free(&assets.pool, asset);
+}
+
+void assets_shutdown(void) {
+  pthread_mutex_lock(&assets.lock);
+  assets.quit = true;
+  pthread_cond_broadcast(&assets.io_wake);
+  pthread_mutex_unlock(&assets.lock);
+  for (int i = 0; i < assets.io_count; ++i)
+    pthread_join(assets.io[i], NULL);
+  assets.io_count = 0;
+  jobs_wait(&assets.decoding);
+
+  for (size_t i = 0; i < assets.live.count; ++i)
+    arena_free(&assets.live.items[i]->arena);
+  arena_free(&assets.arena);
+  pack_close(&assets.pack);
+  memset(&assets.pool, 0, sizeof(assets.pool));
+  memset(&assets.live, 0, sizeof(assets.live));
+  assets.io_head = assets.io_tail = NULL;
+  assets.done_head = assets.done_tail = NULL;
+  assets.in_flight = 0;
+}
+
+AssetHandle assets_load(const char *path, AssetFunc *decode, AssetFunc *upload,
+                        void *user) {
+  Asset *asset = pool_alloc_typed(&assets.pool, Asset);
+  memset(asset, 0, sizeof(*asset));
+  asset->path = arena_strdup(&asset->arena, path);
+  asset->decode = decode;
+  asset->upload = upload;
+  asset->user = user;
+  asset->queued_at = assets_now();
+  arena_da_append(&assets.arena, &assets.live, asset);
+  assets.in_flight++;
+
+  asset->packed = assets.pack.base ? pack_find(&assets.pack, path) : NULL;
+  if (asset->packed) {
+    assets_set_state(asset, ASSET_LOADING);
+    asset->size = asset->packed->raw_size;
+    if (!(asset->packed->flags & PACK_COMPRESSED))
+      asset->data = assets.pack.base + asset->packed->offset;
+    if (asset->data && !asset->decode) {
+      assets_complete(asset, true);
+    } else {
+      jobs_run(assets_decode_job, asset, 1, &assets.decoding);
+    }
+    return pool_handle(&assets.pool, asset);
+  }
+
+  pthread_mutex_lock(&assets.lock);
+  assets_push(&assets.io_head, &assets.io_tail, asset);
+  pthread_cond_signal(&assets.io_wake);
+  pthread_mutex_unlock(&assets.lock);
+  return pool_handle(&assets.pool, asset);
+}
+
+Asset *assets_get(AssetHandle handle) {
+  return (Asset *)pool_get(&assets.pool, handle);
+}
+
+AssetState assets_state(AssetHandle handle) {
+  Asset *asset = assets_get(handle);
+  if (!asset)
+    return ASSET_FAILED;
+  return (AssetState)__atomic_load_n(&asset->state, __ATOMIC_ACQUIRE);
+}
+
+void assets_release(AssetHandle handle) {
+  Asset *asset = assets_get(handle);
+  if (!asset)
+    return;
+  AssetState state = assets_state(handle);
+  if (state == ASSET_READY || state == ASSET_FAILED) {
+    assets_free(asset);
+  } else {
+    asset->released = true;
+  }
+}
+
+size_t assets_in_flight(void) { return assets.in_flight; }
+
+static void assets_finish(Asset *asset) {
+  bool ok = __atomic_load_n(&asset->state, __ATOMIC_ACQUIRE) != ASSET_FAILED;
+  if (ok && !asset->released && asset->upload) {
+    PROFILE_ZONE("asset_upload");
+    ok = asset->upload(asset);
+  }
+  asset->ready_at = assets_now();
+  assets_set_state(asset, ok ? ASSET_READY : ASSET_FAILED);
+  assets.in_flight--;
+  if (asset->released)
+    assets_free(asset);
+}
+
+int assets_update(double budget) {
+  PROFILE_FUNCTION();
+  double start = assets_now();
+  int finished = 0;
+  for (;;) {
+    pthread_mutex_lock(&assets.lock);
+    Asset *asset = assets_pop(&assets.done_head, &assets.done_tail);
+    pthread_mutex_unlock(&assets.lock);
+    if (!asset)
+      break;
+    assets_finish(asset);
+    finished++;
+    if (assets_now() - start >= budget)
+      break;
+  }
+  return finished;
+}
+
+void assets_flush(void) {
+  PROFILE_FUNCTION();
+  while (assets.in_flight > 0) {
+    pthread_mutex_lock(&assets.lock);
+    while (!assets.done_head)
+      pthread_cond_wait(&assets.done_wake, &assets.lock);
+    Asset *asset = assets_pop(&assets.done_head, &assets.done_tail);
+    pthread_mutex_unlock(&assets.lock);
+    assets_finish(asset);
+  }
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "../jobs/jobs.h"
+#include "../utils/pool.h"
+#include "pack.h"
+#include <stdbool.h>
+
+// Asynchronous asset loading.
+//
+// assets_load returns a handle right away. The file is read with pread on
+// one of the IO threads into the asset's own arena, decoded on the job
+// system, and queued for the main loop, where assets_update runs the GL
+// uploads within a per-frame time budget:
+//
+//   QUEUED -> LOADING (IO thread, then decode job) -> UPLOADING -> READY
+//
+// Any stage can end in FAILED. Decode runs on a worker and must not touch
+// GL; upload runs on the thread calling assets_update. Either may be NULL.
+// Handles are generation checked, so a released asset reads as stale.
+//
+// Paths found in a mounted pack (pack.h) skip the IO threads: stored entries
+// point straight into the mapping, compressed ones are decompressed by the
+// decode job. Anything else is read from disk.
+
+#ifndef ASSETS_IO_THREADS
+#define ASSETS_IO_THREADS 2
+#endif
+
+#define ASSETS_READ_CHUNK (1 << 20)
+
+typedef enum {
+  ASSET_QUEUED,
+  ASSET_LOADING,
+  ASSET_UPLOADING,
+  ASSET_READY,
+  ASSET_FAILED,
+} AssetState;
+
+typedef Pool_Handle AssetHandle;
+
+typedef struct Asset Asset;
+typedef bool AssetFunc(Asset *asset);
+typedef void AssetWakeFunc(void);
+
+struct Asset {
+  Asset *next; // IO or completion queue
+  int state;   // AssetState, written by whichever stage owns the asset
+  const char *path;
+  AssetFunc *decode;
+  AssetFunc *upload;
+  void *user;
+  void *result; // set by decode for upload
+
+  // Owned by the asset: file contents and whatever decode allocates. Data
+  // may point into the mounted pack, so it is read-only.
+  Arena arena;
+  const unsigned char *data;
+  size_t size;
+  const PackEntry *packed;
+
+  bool released; // release requested while in flight
+  double queued_at;
+  double ready_at;
+};
+
+bool assets_init(void);
+void assets_shutdown(void);
+// Serve later loads from an archive, false if it can't be opened. Mount
+// before loading, stored assets point into the mapping.
+bool assets_mount(const char *packPath);
+// Called from the loading threads whenever an asset is ready for
+// assets_update, so a main loop blocked on events can wake up
+void assets_set_wake(AssetWakeFunc *wake);
+
+AssetHandle assets_load(const char *path, AssetFunc *decode, AssetFunc *upload,
+                        void *user);
+AssetState assets_state(AssetHandle handle);
+Asset *assets_get(AssetHandle handle); // NULL when stale
+void assets_release(AssetHandle handle);
+
+// Main loop: runs queued uploads for at most `budget` seconds, and at least
+// one so loading always makes progress. Returns how many finished.
+int assets_update(double budget);
+// Blocks until everything loaded so far is READY or FAILED
+void assets_flush(void);
+size_t assets_in_flight(void);
@@ -0,0 +1,370 @@
+#include "pack.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PACK_LZ_HASH_BITS 16
+#define PACK_LZ_MIN_MATCH 4
+#define PACK_LZ_LAST_LITERALS 5 // the block always ends in literals
+#define PACK_LZ_MATCH_LIMIT 12  // no match starts this close to the end
+#define PACK_LZ_MAX_OFFSET 65535
+#define PACK_LZ_EMPTY UINT32_MAX
+// A length byte expands to at most 255 bytes, so no valid block inflates
+// further. Caps what a corrupt raw_size can make pack_data allocate.
+#define PACK_LZ_MAX_RATIO 255
+
+// FNV-1a
+uint64_t pack_hash(const char *name) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (; *name; ++name) {
+    hash ^= (unsigned char)*name;
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+size_t pack_lz_bound(size_t size) { return size + size / 255 + 16; }
+
+static uint32_t pack_lz_read32(const unsigned char *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static unsigned char *pack_lz_write_length(unsigned char *op, size_t length) {
+  for (; length >= 255; length -= 255)
+    *op++ = 255;
+  *op++ = (unsigned char)length;
+  return op;
+}
+
+static unsigned char *pack_lz_write_literals(unsigned char *op,
+                                             const unsigned char *literals,
+                                             size_t count, size_t match) {
+  unsigned char *token = op++;
+  *token = (unsigned char)(((count >= 15 ? 15 : count) << 4) |
+                           (match >= 15 ? 15 : match));
+  if (count >= 15)
+    op = pack_lz_write_length(op, count - 15);
+  memcpy(op, literals, count);
+  return op + count;
+}
+
+// Greedy single-probe matcher, the hash table holds the last position seen
+// for every 4-byte prefix. Misses speed up the scan over incompressible runs.
+size_t pack_lz_compress(const unsigned char *src, size_t size,
+                        unsigned char *dst) {
+  Scratch scratch = scratch_begin(NULL);
+  uint32_t *table = (uint32_t *)arena_alloc(
+      scratch.arena, sizeof(uint32_t) << PACK_LZ_HASH_BITS);
+  memset(table, 0xff, sizeof(uint32_t) << PACK_LZ_HASH_BITS);
+
+  const unsigned char *ip = src;
+  const unsigned char *anchor = src;
+  const unsigned char *end = src + size;
+  unsigned char *op = dst;
+
+  if (size > PACK_LZ_MATCH_LIMIT) {
+    const unsigned char *matchLimit = end - PACK_LZ_MATCH_LIMIT;
+    const unsigned char *extendLimit = end - PACK_LZ_LAST_LITERALS;
+    size_t misses = 0;
+    while (ip < matchLimit) {
+      uint32_t h = (pack_lz_read32(ip) * 2654435761u) >>
+                   (32 - PACK_LZ_HASH_BITS);
+      uint32_t candidate = table[h];
+      table[h] = (uint32_t)(ip - src);
+      if (candidate == PACK_LZ_EMPTY ||
+          (size_t)(ip - src) - candidate > PACK_LZ_MAX_OFFSET ||
+          pack_lz_read32(src + candidate) != pack_lz_read32(ip)) {
+        ip += 1 + (misses++ >> 6);
+        continue;
+      }
+      misses = 0;
+
+      const unsigned char *match = src + candidate;
+      while (ip > anchor && match > src && ip[-1] == match[-1]) {
+        ip--;
+        match--;
+      }
+      const unsigned char *matchEnd = ip + PACK_LZ_MIN_MATCH;
+      const unsigned char *ref = match + PACK_LZ_MIN_MATCH;
+      while (matchEnd < extendLimit && *matchEnd == *ref) {
+        matchEnd++;
+        ref++;
+      }
+
+      size_t length = matchEnd - ip - PACK_LZ_MIN_MATCH;
+      op = pack_lz_write_literals(op, anchor, ip - anchor, length);
+      size_t offset = ip - match;
+      *op++ = (unsigned char)(offset & 0xff);
+      *op++ = (unsigned char)(offset >> 8);
+      if (length >= 15)
+        op = pack_lz_write_length(op, length - 15);
+      ip = anchor = matchEnd;
+    }
+  }
+
+  op = pack_lz_write_literals(op, anchor, end - anchor, 0);
+  scratch_end(scratch);
+  return op - dst;
+}
+
+static bool pack_lz_read_length(const unsigned char **ip,
+                                const unsigned char *end, size_t *length) {
+  unsigned char b;
+  do {
+    if (*ip >= end)
+      return false;
+    b = *(*ip)++;
+    *length += b;
+  } while (b == 255);
+  return true;
+}
+
+size_t pack_lz_decompress(const unsigned char *src, size_t size,
+                          unsigned char *dst, size_t capacity) {
+  const unsigned char *ip = src;
+  const unsigned char *end = src + size;
+  unsigned char *op = dst;
+  unsigned char *outEnd = dst + capacity;
+
+  while (ip < end) {
+    unsigned token = *ip++;
+    size_t literals = token >> 4;
+    if (literals == 15 && !pack_lz_read_length(&ip, end, &literals))
+      return 0;
+    if (literals > (size_t)(end - ip) || literals > (size_t)(outEnd - op))
+      return 0;
+    memcpy(op, ip, literals);
+    op += literals;
+    ip += literals;
+    if (ip == end)
+      break; // the last sequence has no match
+
+    if (end - ip < 2)
+      return 0;
+    size_t offset = ip[0] | (size_t)ip[1] << 8;
+    ip += 2;
+    size_t length = token & 15;
+    if (length == 15 && !pack_lz_read_length(&ip, end, &length))
+      return 0;
+    length += PACK_LZ_MIN_MATCH;
+    if (offset == 0 || offset > (size_t)(op - dst) ||
+        length > (size_t)(outEnd - op))
+      return 0;
+
+    const unsigned char *ref = op - offset;
+    if (offset >= length) {
+      memcpy(op, ref, length);
+    } else {
+      for (size_t i = 0; i < length; ++i) // overlapping run
+        op[i] = ref[i];
+    }
+    op += length;
+  }
+  return op - dst;
+}
+
+bool pack_open(Pack *pack, const char *path) {
+  memset(pack, 0, sizeof(*pack));
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(PackHeader)) {
+    close(fd);
+    return false;
+  }
+  size_t size = (size_t)st.st_size;
+  void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED)
+    return false;
+
+  const PackHeader *header = (const PackHeader *)base;
+  const PackEntry *entries = (const PackEntry *)(header + 1);
+  bool ok = header->magic == PACK_MAGIC && header->version == PACK_VERSION &&
+            header->count <= (size - sizeof(*header)) / sizeof(PackEntry) &&
+            header->names_offset <= size &&
+            header->names_size <= size - header->names_offset &&
+            header->names_size > 0 &&
+            ((const char *)base)[header->names_offset + header->names_size -
+                                 1] == '\0';
+  for (uint32_t i = 0; ok && i < header->count; ++i) {
+    const PackEntry *e = &entries[i];
+    bool compressed = e->flags & PACK_COMPRESSED;
+    ok = e->offset <= size && e->size <= size - e->offset &&
+         (compressed ? e->raw_size / PACK_LZ_MAX_RATIO <= e->size
+                     : e->raw_size == e->size) &&
+         e->name < header->names_size &&
+         (i == 0 || entries[i - 1].hash <= e->hash);
+  }
+  if (!ok) {
+    fprintf(stderr, "Invalid asset pack `%s`\n", path);
+    munmap(base, size);
+    return false;
+  }
+
+  pack->base = (const unsigned char *)base;
+  pack->size = size;
+  pack->entries = entries;
+  pack->count = header->count;
+  pack->names = (const char *)base + header->names_offset;
+  return true;
+}
+
+void pack_close(Pack *pack) {
+  if (pack->base)
+    munmap((void *)pack->base, pack->size);
+  memset(pack, 0, sizeof(*pack));
+}
+
+const PackEntry *pack_find(const Pack *pack, const char *name) {
+  uint64_t hash = pack_hash(name);
+  size_t lo = 0, hi = pack->count;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (pack->entries[mid].hash < hash)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  for (; lo < pack->count && pack->entries[lo].hash == hash; ++lo) {
+    if (strcmp(pack->names + pack->entries[lo].name, name) == 0)
+      return &pack->entries[lo];
+  }
+  return NULL;
+}
+
+const unsigned char *pack_data(const Pack *pack, const PackEntry *entry,
+                               Arena *arena) {
+  const unsigned char *data = pack->base + entry->offset;
+  if (!(entry->flags & PACK_COMPRESSED))
+    return data;
+
+  unsigned char *raw = (unsigned char *)arena_alloc_aligned(
+      arena, entry->raw_size, ARENA_REGION_ALIGNMENT);
+  if (pack_lz_decompress(data, entry->size, raw, entry->raw_size) !=
+      entry->raw_size)
+    return NULL;
+  return raw;
+}
+
+typedef struct {
+  PackEntry entry;
+  const unsigned char *data; // what goes into the archive
+} PackItem;
+
+static int pack_compare_items(const void *a, const void *b) {
+  uint64_t ha = ((const PackItem *)a)->entry.hash;
+  uint64_t hb = ((const PackItem *)b)->entry.hash;
+  return ha < hb ? -1 : ha > hb;
+}
+
+static size_t pack_align(size_t offset, size_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+bool pack_write(const char *path, const PackInput *inputs, size_t count,
+                bool compress) {
+  Arena arena = {0};
+  PackItem *items = (PackItem *)arena_alloc(&arena, count * sizeof(PackItem));
+  size_t namesSize = 0;
+  for (size_t i = 0; i < count; ++i) {
+    size_t size = 0;
+    FILE *f = fopen(inputs[i].path, "rb");
+    unsigned char *data = NULL;
+    if (f) {
+      fseek(f, 0, SEEK_END);
+      size = (size_t)ftell(f);
+      fseek(f, 0, SEEK_SET);
+      data = (unsigned char *)arena_alloc(&arena, size);
+      if (fread(data, 1, size, f) != size)
+        data = NULL;
+      fclose(f);
+    }
+    if (!data) {
+      fprintf(stderr, "Could not read `%s`\n", inputs[i].path);
+      arena_free(&arena);
+      return false;
+    }
+
+    PackItem *item = &items[i];
+    item->entry = (PackEntry){
+        .hash = pack_hash(inputs[i].name),
+        .size = size,
+        .raw_size = size,
+        .name = (uint32_t)namesSize,
+    };
+    item->data = data;
+    namesSize += strlen(inputs[i].name) + 1;
+
+    if (compress) {
+      unsigned char *packed =
+          (unsigned char *)arena_alloc(&arena, pack_lz_bound(size));
+      size_t packedSize = pack_lz_compress(data, size, packed);
+      if (packedSize <= size - size / 8) {
+        item->entry.flags |= PACK_COMPRESSED;
+        item->entry.size = packedSize;
+        item->data = packed;
+      }
+    }
+  }
+
+  char *names = (char *)arena_alloc(&arena, namesSize ? namesSize : 1);
+  names[0] = '\0';
+  for (size_t i = 0; i < count; ++i) {
+    strcpy(names + items[i].entry.name, inputs[i].name);
+  }
+  qsort(items, count, sizeof(*items), pack_compare_items);
+
+  // Stored entries first so the padding only sits between them
+  size_t offset = sizeof(PackHeader) + count * sizeof(PackEntry) + namesSize;
+  for (int pass = 0; pass < 2; ++pass) {
+    for (size_t i = 0; i < count; ++i) {
+      PackEntry *e = &items[i].entry;
+      if ((pass == 0) != !(e->flags & PACK_COMPRESSED))
+        continue;
+      offset = pack_align(offset, pass == 0 ? PACK_ALIGNMENT : 8);
+      e->offset = offset;
+      offset += e->size;
+    }
+  }
+
+  PackHeader header = {
+      .magic = PACK_MAGIC,
+      .version = PACK_VERSION,
+      .count = (uint32_t)count,
+      .names_offset = sizeof(PackHeader) + count * sizeof(PackEntry),
+      .names_size = namesSize ? namesSize : 1,
+  };
+
+  char tmp[4096];
+  snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+  FILE *f = fopen(tmp, "wb");
+  if (!f) {
+    fprintf(stderr, "Could not open `%s`\n", tmp);
+    arena_free(&arena);
+    return false;
+  }
+  fwrite(&header, sizeof(header), 1, f);
+  for (size_t i = 0; i < count; ++i)
+    fwrite(&items[i].entry, sizeof(PackEntry), 1, f);
+  fwrite(names, 1, header.names_size, f);
+  for (size_t i = 0; i < count; ++i) {
+    // Entries were laid out in increasing offsets per pass, seek to each
+    fseek(f, (long)items[i].entry.offset, SEEK_SET);
+    fwrite(items[i].data, 1, items[i].entry.size, f);
+  }
+  bool ok = !ferror(f);
+  ok = fclose(f) == 0 && ok;
+  ok = ok && rename(tmp, path) == 0;
+  if (!ok)
+    fprintf(stderr, "Could not write `%s`\n", path);
+  arena_free(&arena);
+  return ok;
+}
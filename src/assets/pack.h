@@ -0,0 +1,78 @@
+#pragma once
+#include "../utils/memory.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Packed asset archive, written by `./build pack` and mmap'ed at runtime.
+//
+//   header   PackHeader
+//   index    PackEntry[count], sorted by FNV-1a hash of the name
+//   names    NUL-terminated entry names
+//   data     stored entries at PACK_ALIGNMENT, compressed ones after them
+//
+// Stored entries are served as pointers into the mapping. Compressed entries
+// use the LZ4 block format and are decompressed into the caller's arena.
+// pack_open rejects stored entries whose raw_size is not their size, and
+// compressed ones claiming more than the format can expand to.
+// Looking an entry up is a binary search over the index, names are compared
+// only to rule out hash collisions.
+
+#define PACK_MAGIC 0x4b504752u // "RGPK"
+#define PACK_VERSION 1
+#define PACK_ALIGNMENT 4096
+
+#define PACK_COMPRESSED 1u
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t count;
+  uint32_t reserved;
+  uint64_t names_offset;
+  uint64_t names_size;
+} PackHeader;
+
+typedef struct {
+  uint64_t hash;
+  uint64_t offset;
+  uint64_t size;     // bytes in the archive
+  uint64_t raw_size; // bytes once decompressed
+  uint32_t flags;
+  uint32_t name; // offset into the names table
+} PackEntry;
+
+typedef struct {
+  const unsigned char *base;
+  size_t size;
+  const PackEntry *entries;
+  uint32_t count;
+  const char *names;
+} Pack;
+
+uint64_t pack_hash(const char *name);
+
+bool pack_open(Pack *pack, const char *path);
+void pack_close(Pack *pack);
+const PackEntry *pack_find(const Pack *pack, const char *name);
+// Pointer into the mapping for stored entries, decompressed into `arena`
+// otherwise. NULL if the entry is corrupt.
+const unsigned char *pack_data(const Pack *pack, const PackEntry *entry,
+                               Arena *arena);
+
+typedef struct {
+  const char *name;
+  const char *path; // file to read it from
+} PackInput;
+
+// Entries are compressed when that saves at least 1/8 of their size
+bool pack_write(const char *path, const PackInput *inputs, size_t count,
+                bool compress);
+
+// LZ4 block format. `dst` needs pack_lz_bound(size) bytes for compression,
+// decompression returns 0 on malformed input or if `capacity` is exceeded.
+size_t pack_lz_bound(size_t size);
+size_t pack_lz_compress(const unsigned char *src, size_t size,
+                        unsigned char *dst);
+size_t pack_lz_decompress(const unsigned char *src, size_t size,
+                          unsigned char *dst, size_t capacity);
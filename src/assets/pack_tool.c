@@ -0,0 +1,83 @@
+#include "pack.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+// pack [--compress] <directory> <archive>
+//
+// Bundles every file under <directory> into <archive>. Entries are named by
+// their path as given, e.g. "assets/fonts/ProtoNerdFont.ttf", which is the
+// same path the engine asks the asset system for. Entries are stored for
+// zero-copy access unless --compress is given.
+
+typedef struct {
+  PackInput *items;
+  size_t count;
+  size_t capacity;
+} PackInputs;
+
+static bool collect(Arena *arena, const char *dir, PackInputs *inputs) {
+  DIR *d = opendir(dir);
+  if (!d) {
+    fprintf(stderr, "Could not open directory `%s`\n", dir);
+    return false;
+  }
+  bool ok = true;
+  struct dirent *ent;
+  while (ok && (ent = readdir(d)) != NULL) {
+    if (ent->d_name[0] == '.')
+      continue;
+    char *path = arena_sprintf(arena, "%s/%s", dir, ent->d_name);
+    struct stat st;
+    if (stat(path, &st) != 0)
+      continue;
+    if (S_ISDIR(st.st_mode)) {
+      ok = collect(arena, path, inputs);
+    } else if (S_ISREG(st.st_mode)) {
+      PackInput input = {.name = path, .path = path};
+      arena_da_append(arena, inputs, input);
+    }
+  }
+  closedir(d);
+  return ok;
+}
+
+int main(int argc, char *argv[]) {
+  bool compress = false;
+  int arg = 1;
+  if (arg < argc && strcmp(argv[arg], "--compress") == 0) {
+    compress = true;
+    arg++;
+  }
+  if (argc - arg != 2) {
+    fprintf(stderr, "Usage: %s [--compress] <directory> <archive>\n",
+            argv[0]);
+    return 1;
+  }
+
+  Arena arena = {0};
+  PackInputs inputs = {0};
+  if (!collect(&arena, argv[arg], &inputs))
+    return 1;
+  if (!pack_write(argv[arg + 1], inputs.items, inputs.count, compress))
+    return 1;
+
+  Pack pack;
+  if (!pack_open(&pack, argv[arg + 1]))
+    return 1;
+  size_t raw = 0, stored = 0;
+  for (uint32_t i = 0; i < pack.count; ++i) {
+    const PackEntry *e = &pack.entries[i];
+    raw += e->raw_size;
+    stored += e->size;
+    printf("  %-40s %10llu -> %10llu%s\n", pack.names + e->name,
+           (unsigned long long)e->raw_size, (unsigned long long)e->size,
+           e->flags & PACK_COMPRESSED ? " lz" : "");
+  }
+  printf("%s: %u entries, %zu -> %zu bytes (%zu on disk)\n", argv[arg + 1],
+         pack.count, raw, stored, pack.size);
+  pack_close(&pack);
+  arena_free(&arena);
+  return 0;
+}
@@ -1,55 +1,367 @@
 #include "game_app.h"
 
+static double game_app_wall_time(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// GameApp lives inside its own persistent arena
+static void game_app_release(GameApp *app) {
+  Arena persistent = app->persistent;
+  arena_free(&app->frameArenas[0]);
+  arena_free(&app->frameArenas[1]);
+  arena_free(&persistent);
+}
+
+// Regular polygons with 3 to 8 sides as triangle fans, white in the middle
+#define GAME_APP_SCENE_MESHES 6
+static int game_app_create_scene(GameApp *app) {
+  if (!geometry_pool_create(&app->scene, &app->stream, 1024, 1024,
+                            !app->appInfo->directDraws)) {
+    return 0;
+  }
+  static const uint32_t rims[GAME_APP_SCENE_MESHES] = {
+      0xE8505BFF, 0xF9D56EFF, 0x14B1ABFF,
+      0x3D8BFFFF, 0xA06CD5FF, 0xF3ECC2FF,
+  };
+  for (int m = 0; m < GAME_APP_SCENE_MESHES; ++m) {
+    int sides = 3 + m;
+    GeometryVertex vertices[9] = {{0, 0, 0xFFFFFFFF}};
+    uint32_t indices[8 * 3];
+    for (int i = 0; i < sides; ++i) {
+      float a = 2.0f * (float)M_PI * i / sides;
+      vertices[1 + i] = (GeometryVertex){cosf(a), sinf(a), rims[m]};
+      indices[3 * i] = 0;
+      indices[3 * i + 1] = 1 + i;
+      indices[3 * i + 2] = 1 + (i + 1) % sides;
+    }
+    if (geometry_pool_add_mesh(&app->scene, vertices, 1 + sides, indices,
+                               3 * sides) < 0) {
+      return 0;
+    }
+  }
+  app->sceneMeshes = GAME_APP_SCENE_MESHES;
+  printf("scene: %d objects, %s\n", app->appInfo->sceneObjects,
+         app->scene.indirect ? "multi-draw-indirect" : "direct draws");
+  return 1;
+}
+
 GameApp *game_app_create(GameAppCreateInfo *createInfo) {
-  GameApp *app = (GameApp *)malloc(sizeof(GameApp));
+  PROFILE_FUNCTION();
+  Arena persistent = {0};
+  GameApp *app = (GameApp *)arena_alloc(&persistent, sizeof(GameApp));
+  memset(app, 0, sizeof(GameApp));
+  app->persistent = persistent;
+  app->frameArena = &app->frameArenas[0];
   app->appInfo = createInfo;
+  input_queue_init(&app->inputQueue);
 
-  if (!glfwInit()) {
-    fprintf(stderr, "Failed to initialize GLFW\n");
-    free(app);
+  if (app->appInfo->replayPath) {
+    if (!input_replay_open(&app->replay, &app->persistent,
+                           app->appInfo->replayPath)) {
+      game_app_release(app);
+      return NULL;
+    }
+    app->replaying = true;
+    app->appInfo->headless = true;
+    app->appInfo->headlessFrames = (int)app->replay.frames;
+    app->appInfo->width = (int)app->replay.header.width;
+    app->appInfo->height = (int)app->replay.header.height;
+  }
+  app->input.width = app->appInfo->width;
+  app->input.height = app->appInfo->height;
+
+  // Straight from the command line, it becomes a printf format
+  if (app->appInfo->dumpPath && !frame_pattern_valid(app->appInfo->dumpPath)) {
+    fprintf(stderr, "Dump path `%s` needs exactly one %%d\n",
+            app->appInfo->dumpPath);
+    game_app_release(app);
     return NULL;
   }
 
-  app->window = make_window(app->appInfo->width, app->appInfo->height);
-  if (!app->window) {
-    GLCall(glfwTerminate());
-    free(app);
+  if (app->appInfo->headless) {
+    if (!make_headless_context(app)) {
+      game_app_release(app);
+      return NULL;
+    }
+  } else {
+    if (!glfwInit()) {
+      fprintf(stderr, "Failed to initialize GLFW\n");
+      game_app_release(app);
+      return NULL;
+    }
+
+    app->window = make_window(app->appInfo->width, app->appInfo->height);
+    if (!app->window) {
+      GLCall(glfwTerminate());
+      game_app_release(app);
+      return NULL;
+    }
+
+    GLCall(glfwSetWindowUserPointer(app->window, app));
+    GLCall(glfwSetFramebufferSizeCallback(app->window,
+                                          framebuffer_size_callback));
+    GLCall(glfwSetMouseButtonCallback(app->window, mouse_button_callback));
+    GLCall(glfwSetKeyCallback(app->window, key_callback));
+    GLCall(glfwSetCursorPosCallback(app->window, cursor_pos_callback));
+    GLCall(glfwSetScrollCallback(app->window, scroll_callback));
+    GLCall(glfwSetWindowRefreshCallback(app->window, window_refresh_callback));
+
+    glfwSwapInterval(20);
+  }
+
+  // The headless framebuffer binding predates this, it's relearned
+  gl_state_init(NULL);
+  GPU_PROFILE_INIT(&app->gpuProfiler);
+
+  jobs_init(app->appInfo->jobWorkers, app->appInfo->pinThreads);
+  assets_init();
+  if (app->appInfo->onDemand && !app->appInfo->headless) {
+    assets_set_wake(glfwPostEmptyEvent);
+  }
+  app->redraw = true;
+  if (app->appInfo->packPath && !assets_mount(app->appInfo->packPath)) {
+    fprintf(stderr, "Could not mount `%s`, reading assets from disk\n",
+            app->appInfo->packPath);
+  }
+
+  shader_cache_init(app->appInfo->shaderCachePath);
+
+  if (!buffer_ring_create(&app->stream, BUFFER_RING_SIZE,
+                          !app->appInfo->orphanBuffers)) {
+    game_app_destroy(app);
     return NULL;
   }
+  printf("buffer ring: %zu KiB, %s\n", app->stream.size / 1024,
+         app->stream.mapped ? "persistent" : "orphaning");
 
-  GLCall(glfwSetWindowUserPointer(app->window, app));
-  GLCall(
-      glfwSetFramebufferSizeCallback(app->window, framebuffer_size_callback));
-  GLCall(glfwSetMouseButtonCallback(app->window, mouse_button_callback));
-  GLCall(glfwSetKeyCallback(app->window, key_callback));
+  // The overlay shows up once the font has streamed in
+  if (!text_renderer_create(&app->text)) {
+    game_app_destroy(app);
+    return NULL;
+  }
+  app->fontAsset = assets_load(app->appInfo->font_path, game_app_decode_font,
+                               game_app_upload_font, app);
+  if (app->appInfo->pathSegments > 0 &&
+      !path_renderer_create(&app->path, &app->stream)) {
+    game_app_destroy(app);
+    return NULL;
+  }
+  if (app->appInfo->sceneObjects > 0 && !game_app_create_scene(app)) {
+    game_app_destroy(app);
+    return NULL;
+  }
 
-  glfwSwapInterval(20);
+  const char *capturePath = app->appInfo->capturePath;
+  if (!capturePath && app->appInfo->headless) {
+    capturePath = app->appInfo->dumpPath;
+  }
+  if (capturePath &&
+      !capture_open(&app->capture, capturePath, app->appInfo->width,
+                    app->appInfo->height,
+                    (int)(1.0 / GAME_APP_FIXED_DT + 0.5))) {
+    game_app_destroy(app);
+    return NULL;
+  }
 
   // TODO: Renderer and Engine
 
-  GLCall(app->appInfo->lastTime = glfwGetTime());
+  if (app->appInfo->recordPath) {
+    input_recorder_open(&app->recorder, app->appInfo->recordPath,
+                        app->appInfo->width, app->appInfo->height,
+                        GAME_APP_FIXED_DT);
+  }
+  if (app->appInfo->timingsPath) {
+    app->timings = fopen(app->appInfo->timingsPath, "w");
+    if (app->timings) {
+      fprintf(app->timings, "frame,ms\n");
+    } else {
+      fprintf(stderr, "Could not open `%s`\n", app->appInfo->timingsPath);
+    }
+  }
+
+  // Headless runs compare frames, they can't have assets pop in mid-run
+  if (app->appInfo->headless) {
+    assets_flush();
+  }
+
+  ShaderCacheStats shaderStats = shader_cache_stats();
+  printf("shaders: %.3f ms (%d cached, %d compiled, %d rejected)\n",
+         shaderStats.seconds * 1000.0, shaderStats.hits, shaderStats.misses,
+         shaderStats.rejected);
+
+  app->appInfo->lastTime = game_app_get_time(app);
   app->appInfo->currentTime = app->appInfo->lastTime;
   app->appInfo->numFrames = 0;
+  app->frameStart = game_app_wall_time();
+  app->startTime = app->appInfo->lastTime;
 
   return app;
 }
 
+// A wobbling star of quadratic spikes, rebuilt every frame. It runs on the
+// frame index so headless dumps stay reproducible.
+static void game_app_draw_path(GameApp *app) {
+  PROFILE_FUNCTION();
+  int count = app->appInfo->pathSegments;
+  PathSegment *segments = (PathSegment *)arena_alloc(
+      app->frameArena, (size_t)count * sizeof(PathSegment));
+  float t = (float)(app->frameIndex * GAME_APP_FIXED_DT);
+  float cx = app->appInfo->width * 0.5f, cy = app->appInfo->height * 0.5f;
+  float radius = 0.4f * (cx < cy ? cx : cy);
+  for (int i = 0; i < count; ++i) {
+    float a0 = 2.0f * (float)M_PI * i / count;
+    float a1 = 2.0f * (float)M_PI * (i + 1) / count;
+    float am = 0.5f * (a0 + a1);
+    float r0 = radius * (0.75f + 0.25f * sinf(7.0f * a0 + t));
+    float r1 = radius * (0.75f + 0.25f * sinf(7.0f * a1 + t));
+    float rm = radius * (i & 1 ? 1.3f : 0.7f);
+    segments[i] = (PathSegment){
+        .kind = PATH_QUAD,
+        .x1 = cx + r0 * cosf(a0),
+        .y1 = cy + r0 * sinf(a0),
+        .x2 = cx + rm * cosf(am),
+        .y2 = cy + rm * sinf(am),
+        .x3 = cx + r1 * cosf(a1),
+        .y3 = cy + r1 * sinf(a1),
+    };
+  }
+  path_renderer_fill(&app->path, segments, (size_t)count, 0x3D8BFFFF,
+                     app->appInfo->width, app->appInfo->height);
+}
+
+// Objects spread over a grid, each spinning at its own rate
+static void game_app_draw_scene(GameApp *app) {
+  PROFILE_FUNCTION();
+  int count = app->appInfo->sceneObjects;
+  int columns = (int)ceilf(sqrtf((float)count * app->appInfo->width /
+                                 app->appInfo->height));
+  int rows = (count + columns - 1) / columns;
+  float cellWidth = (float)app->appInfo->width / columns;
+  float cellHeight = (float)app->appInfo->height / rows;
+  float t = (float)(app->frameIndex * GAME_APP_FIXED_DT);
+
+  geometry_pool_begin(&app->scene);
+  for (int i = 0; i < count; ++i) {
+    GeometryDraw draw = {
+        .x = (i % columns + 0.5f) * cellWidth,
+        .y = (i / columns + 0.5f) * cellHeight,
+        .scale = 0.45f * (cellWidth < cellHeight ? cellWidth : cellHeight),
+        .rotation = t * (1.0f + (i % 7) * 0.25f),
+        .r = 1.0f,
+        .g = 1.0f,
+        .b = 1.0f,
+        .a = 0.8f,
+    };
+    geometry_pool_draw(&app->scene, i % app->sceneMeshes, &draw);
+  }
+  geometry_pool_flush(&app->scene, app->appInfo->width, app->appInfo->height);
+}
+
+void game_app_request_redraw(GameApp *app) { app->redraw = true; }
+
+// --capture takes every frame, --dump every dumpEvery-th or the last one
+static bool game_app_capture_due(GameApp *app) {
+  if (app->appInfo->capturePath)
+    return true;
+  if (app->appInfo->dumpEvery > 0)
+    return app->frameIndex % app->appInfo->dumpEvery == 0;
+  return (int)app->frameIndex + 1 >= app->appInfo->headlessFrames;
+}
+
+// On demand and nothing to draw: sleep until an event, a wake from the
+// asset threads, or the next overlay update is due
+static returnCode game_app_wait(GameApp *app) {
+  PROFILE_FUNCTION();
+  double untilOverlay =
+      1.0 - (game_app_get_time(app) - app->appInfo->lastTime);
+  GLCall(glfwWaitEventsTimeout(untilOverlay > 0 ? untilOverlay : 0));
+  input_queue_flush(&app->inputQueue);
+  if (game_app_get_time(app) - app->appInfo->lastTime >= 1.0) {
+    game_app_request_redraw(app);
+  }
+  if (app->quitRequested || glfwWindowShouldClose(app->window)) {
+    return QUIT;
+  }
+  return CONTINUE;
+}
+
 returnCode game_app_main_loop(GameApp *app) {
-  calculate_frame_rate(app);
+  PROFILE_FUNCTION();
+  // Last frame's allocations stay valid for one more frame
+  app->frameArena = &app->frameArenas[app->frameIndex & 1];
+  arena_reset(app->frameArena);
+
+  game_app_process_input(app);
 
-  // TODO: Update mouse position in Engine
-  // GLCall(glfwGetCursorPos(app->window, &app->renderer->mouseX,
-  // &app->renderer->mouseY));
+  if (assets_update(app->appInfo->assetUploadBudget) > 0) {
+    game_app_request_redraw(app);
+  }
+  if (app->fontAsset.generation &&
+      assets_state(app->fontAsset) >= ASSET_READY) {
+    assets_release(app->fontAsset);
+    app->fontAsset = (AssetHandle){0};
+  }
+  if (app->appInfo->onDemand && !app->appInfo->headless && !app->redraw) {
+    return game_app_wait(app);
+  }
+  app->redraw = false;
+  calculate_frame_rate(app);
+  GPU_PROFILE_BEGIN_FRAME(&app->gpuProfiler);
 
-  GLCall(glViewport(0, 0, app->appInfo->width, app->appInfo->height));
-  GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+  GPU_PROFILE_BEGIN(&app->gpuProfiler, "clear");
+  gl_state_viewport(0, 0, app->appInfo->width, app->appInfo->height);
+  GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT |
+                 GL_STENCIL_BUFFER_BIT));
+  GPU_PROFILE_END(&app->gpuProfiler);
 
   // TODO: Engine render
 
+  if (app->scene.program) {
+    GPU_PROFILE_BEGIN(&app->gpuProfiler, "scene");
+    game_app_draw_scene(app);
+    GPU_PROFILE_END(&app->gpuProfiler);
+    game_app_request_redraw(app); // animated
+  }
+
+  if (app->path.program) {
+    GPU_PROFILE_BEGIN(&app->gpuProfiler, "path");
+    game_app_draw_path(app);
+    GPU_PROFILE_END(&app->gpuProfiler);
+    game_app_request_redraw(app); // animated
+  }
+
+  GPU_PROFILE_BEGIN(&app->gpuProfiler, "overlay");
+  text_renderer_begin(&app->text);
+  text_renderer_draw_string(&app->text, 8, 8, app->overlayText, 0xFFFFFFFF);
+  text_renderer_flush(&app->text, app->appInfo->width, app->appInfo->height);
+  GPU_PROFILE_END(&app->gpuProfiler);
+
+  buffer_ring_end_frame(&app->stream);
+  gl_state_end_frame();
+  if (app->capture.path && game_app_capture_due(app)) {
+    capture_frame(&app->capture, app->frameIndex, app->appInfo->width,
+                  app->appInfo->height);
+  }
+  GPU_PROFILE_END_FRAME(&app->gpuProfiler);
+
+  if (app->appInfo->headless) {
+    returnCode code = headless_end_frame(app);
+    return app->quitRequested ? QUIT : code;
+  }
+
+  PROFILE_BEGIN("swap_buffers");
   GLCall(glfwSwapBuffers(app->window));
+  PROFILE_END();
+
+  PROFILE_BEGIN("poll_events");
   GLCall(glfwPollEvents());
+  input_queue_flush(&app->inputQueue);
+  PROFILE_END();
 
-  if (glfwWindowShouldClose(app->window)) {
+  app->frameIndex++;
+  if (app->quitRequested || glfwWindowShouldClose(app->window)) {
     return QUIT;
   }
   return CONTINUE;
@@ -57,9 +369,104 @@ returnCode game_app_main_loop(GameApp *app) {
 
 void game_app_destroy(GameApp *app) {
   // engine_destroy(app->renderer);
-  GLCall(glfwDestroyWindow(app->window));
-  GLCall(glfwTerminate());
-  free(app);
+  if (app->recorder.file) {
+    printf("\nrecorded %zu frames, %zu events to `%s`\n", app->recorder.frames,
+           app->recorder.events, app->appInfo->recordPath);
+    input_recorder_close(&app->recorder);
+  }
+  if (app->timings) {
+    fclose(app->timings);
+  }
+  assets_shutdown();
+  text_renderer_destroy(&app->text);
+  if (app->path.program) {
+    path_renderer_destroy(&app->path);
+  }
+  if (app->scene.program) {
+    geometry_pool_destroy(&app->scene);
+  }
+  if (app->capture.path) {
+    capture_close(&app->capture);
+    printf("\ncapture: %zu frames written, %zu GPU waits, %zu disk waits, "
+           "%zu skipped\n",
+           app->capture.written, app->capture.gpuWaits,
+           app->capture.diskWaits, app->capture.skipped);
+  }
+  if (app->stream.buffer) {
+    printf("\nbuffer ring: %zu waits, %zu grows, %zu orphans\n",
+           app->stream.waits, app->stream.grows, app->stream.orphans);
+    buffer_ring_destroy(&app->stream);
+  }
+  GlStateCounters glLast = gl_state_last_frame();
+  GlStateCounters glTotal = gl_state_total();
+  printf("gl state: %zu issued, %zu filtered (last frame %zu, %zu)\n",
+         glTotal.issued, glTotal.filtered, glLast.issued, glLast.filtered);
+  jobs_shutdown();
+  GPU_PROFILE_DESTROY(&app->gpuProfiler);
+  if (app->appInfo->headless) {
+    if (app->frameIndex > 0) {
+      printf("\nheadless: %lu frames, avg %.3f ms, min %.3f ms, max %.3f ms\n",
+             app->frameIndex, app->frameTimeTotal * 1000.0 / app->frameIndex,
+             app->frameTimeMin * 1000.0, app->frameTimeMax * 1000.0);
+    }
+    destroy_headless_context(app);
+  } else {
+    GLCall(glfwDestroyWindow(app->window));
+    GLCall(glfwTerminate());
+  }
+  ARENA_STATS_REPORT(&app->frameArenas[0], "frame[0]", stdout);
+  ARENA_STATS_REPORT(&app->frameArenas[1], "frame[1]", stdout);
+  ARENA_STATS_REPORT(&app->persistent, "persistent", stdout);
+  scratch_free();
+  game_app_release(app);
+}
+
+bool game_app_decode_font(Asset *asset) {
+  TextFont *font = (TextFont *)arena_alloc(&asset->arena, sizeof(TextFont));
+  asset->result = font;
+  return text_font_decode(font, &asset->arena, asset->data, asset->size, 16);
+}
+
+bool game_app_upload_font(Asset *asset) {
+  GameApp *app = (GameApp *)asset->user;
+  text_renderer_set_font(&app->text, (const TextFont *)asset->result);
+  return true;
+}
+
+double game_app_get_time(GameApp *app) {
+  if (app->replaying) {
+    return app->frameIndex * app->replay.header.dt;
+  }
+  if (app->appInfo->headless) {
+    return game_app_wall_time();
+  }
+  GLCall(double time = glfwGetTime());
+  return time;
+}
+
+// Stands in for present: finishes the frame so frame times are comparable
+// between runs, dumps it if requested and counts towards headlessFrames.
+returnCode headless_end_frame(GameApp *app) {
+  PROFILE_FUNCTION();
+  GLCall(glFinish());
+
+  // Wall clock even when replaying, the timestep only drives the app clock
+  double now = game_app_wall_time();
+  double frameTime = now - app->frameStart;
+  app->frameStart = now;
+  app->frameTimeTotal += frameTime;
+  if (app->frameIndex == 0 || frameTime < app->frameTimeMin)
+    app->frameTimeMin = frameTime;
+  if (frameTime > app->frameTimeMax)
+    app->frameTimeMax = frameTime;
+  if (app->timings) {
+    fprintf(app->timings, "%lu,%.4f\n", app->frameIndex, frameTime * 1000.0);
+  }
+
+  // Dumps went out through the capture in the main loop
+  int last = (int)app->frameIndex + 1 >= app->appInfo->headlessFrames;
+  app->frameIndex++;
+  return last ? QUIT : CONTINUE;
 }
 
 GLFWwindow *make_window(int width, int height) {
@@ -85,20 +492,183 @@ GLFWwindow *make_window(int width, int height) {
   return window;
 }
 
+int make_headless_context(GameApp *app) {
+  EGLDisplay display = EGL_NO_DISPLAY;
+  PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+      (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress(
+          "eglGetPlatformDisplayEXT");
+  if (getPlatformDisplay) {
+    display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+                                 EGL_DEFAULT_DISPLAY, NULL);
+  }
+  if (display == EGL_NO_DISPLAY) {
+    display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  }
+  if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL)) {
+    fprintf(stderr, "Failed to initialize EGL\n");
+    return 0;
+  }
+  eglBindAPI(EGL_OPENGL_API);
+
+  // The surfaceless platform may expose no configs at all, in which case
+  // EGL_KHR_no_config_context lets us create the context without one.
+  EGLint configAttribs[] = {
+      EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+      EGL_NONE,
+  };
+  EGLConfig config = EGL_NO_CONFIG_KHR;
+  EGLint numConfigs = 0;
+  if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) ||
+      numConfigs == 0) {
+    config = EGL_NO_CONFIG_KHR;
+  }
+
+  EGLint contextAttribs[] = {
+      EGL_CONTEXT_MAJOR_VERSION,
+      3,
+      EGL_CONTEXT_MINOR_VERSION,
+      3,
+      EGL_CONTEXT_OPENGL_PROFILE_MASK,
+      EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+      EGL_NONE,
+  };
+  EGLContext context =
+      eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+  if (context == EGL_NO_CONTEXT ||
+      !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+    fprintf(stderr, "Failed to create headless GL context\n");
+    eglTerminate(display);
+    return 0;
+  }
+  app->eglDisplay = display;
+  app->eglContext = context;
+
+  // GLEW resolves through GLX and complains about the missing display, the
+  // entry points it loads still dispatch to the current EGL context.
+  glewExperimental = GL_TRUE;
+  GLenum glewError = glewInit();
+  if (glewError != GLEW_OK && glewError != GLEW_ERROR_NO_GLX_DISPLAY) {
+    fprintf(stderr, "Failed to initialize GLEW\n");
+    destroy_headless_context(app);
+    return 0;
+  }
+  gl_clear_error();
+
+  int width = app->appInfo->width;
+  int height = app->appInfo->height;
+  GLCall(glGenRenderbuffers(1, &app->colorRenderbuffer));
+  GLCall(glBindRenderbuffer(GL_RENDERBUFFER, app->colorRenderbuffer));
+  GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+  GLCall(glGenRenderbuffers(1, &app->depthRenderbuffer));
+  GLCall(glBindRenderbuffer(GL_RENDERBUFFER, app->depthRenderbuffer));
+  GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width,
+                               height));
+
+  GLCall(glGenFramebuffers(1, &app->fbo));
+  GLCall(glBindFramebuffer(GL_FRAMEBUFFER, app->fbo));
+  GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                   GL_RENDERBUFFER, app->colorRenderbuffer));
+  GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                                   GL_RENDERBUFFER, app->depthRenderbuffer));
+  GLCall(GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    fprintf(stderr, "Headless framebuffer incomplete: 0x%x\n", status);
+    destroy_headless_context(app);
+    return 0;
+  }
+
+  return 1;
+}
+
+void destroy_headless_context(GameApp *app) {
+  if (app->fbo) {
+    gl_state_invalidate();
+    GLCall(glDeleteFramebuffers(1, &app->fbo));
+    GLCall(glDeleteRenderbuffers(1, &app->colorRenderbuffer));
+    GLCall(glDeleteRenderbuffers(1, &app->depthRenderbuffer));
+  }
+  eglMakeCurrent(app->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                 EGL_NO_CONTEXT);
+  eglDestroyContext(app->eglDisplay, app->eglContext);
+  eglTerminate(app->eglDisplay);
+}
+
+static void game_app_handle_event(GameApp *app, const InputEvent *event) {
+  input_state_apply(&app->input, event);
+  game_app_request_redraw(app);
+
+  if (event->type == INPUT_KEY && event->code == GLFW_KEY_ESCAPE &&
+      event->action == INPUT_PRESS) {
+    app->quitRequested = true;
+  } else if (event->type == INPUT_MOUSE_BUTTON &&
+             event->code == GLFW_MOUSE_BUTTON_LEFT) {
+    // TODO: Left Mouse press/release in Engine
+  }
+}
+
+// Engine side of the input queue, runs on the tick thread
+void game_app_process_input(GameApp *app) {
+  PROFILE_FUNCTION();
+  input_state_begin_tick(&app->input);
+
+  if (app->replaying) {
+    double time;
+    const InputEvent *events;
+    size_t count;
+    if (input_replay_next(&app->replay, &time, &events, &count)) {
+      for (size_t i = 0; i < count; ++i)
+        game_app_handle_event(app, &events[i]);
+    }
+  } else {
+    struct {
+      InputEvent *items;
+      size_t count;
+      size_t capacity;
+    } events = {0};
+
+    InputEvent event;
+    while (input_queue_pop(&app->inputQueue, &event)) {
+      game_app_handle_event(app, &event);
+      if (app->recorder.file)
+        arena_da_append(app->frameArena, &events, event);
+    }
+    if (app->recorder.file) {
+      input_recorder_frame(&app->recorder,
+                           game_app_get_time(app) - app->startTime,
+                           events.items, events.count);
+    }
+  }
+
+  if (app->input.resized) {
+    app->appInfo->width = app->input.width;
+    app->appInfo->height = app->input.height;
+  }
+}
+
 void key_callback(GLFWwindow *window, int key, int scancode, int action,
                   int mods) {
+  (void)scancode;
   GameApp *app = (GameApp *)glfwGetWindowUserPointer(window);
-
-  if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
-    glfwSetWindowShouldClose(window, GLFW_TRUE);
-  }
+  InputEvent event = {.type = INPUT_KEY,
+                      .action = (uint8_t)action,
+                      .mods = (uint16_t)mods,
+                      .code = key};
+  input_queue_push(&app->inputQueue, event);
 }
 
 void calculate_frame_rate(GameApp *app) {
-  GLCall(app->appInfo->currentTime = glfwGetTime());
+  app->appInfo->currentTime = game_app_get_time(app);
   app->appInfo->numFrames++;
   if (app->appInfo->currentTime - app->appInfo->lastTime >= 1.0) {
-    printf("\rFPS: %d", app->appInfo->numFrames);
+#ifdef PROFILER_ENABLED
+    snprintf(app->overlayText, sizeof(app->overlayText),
+             "FPS: %d GPU: %.3f ms", app->appInfo->numFrames,
+             app->gpuProfiler.last_frame_ms);
+#else
+    snprintf(app->overlayText, sizeof(app->overlayText), "FPS: %d",
+             app->appInfo->numFrames);
+#endif
+    printf("\r%s", app->overlayText);
     fflush(stdout);
     app->appInfo->numFrames = 0;
     app->appInfo->lastTime += 1.0;
@@ -107,19 +677,39 @@ void calculate_frame_rate(GameApp *app) {
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height) {
   GLCall(GameApp *app = (GameApp *)glfwGetWindowUserPointer(window));
-  GLCall(glViewport(0, 0, width, height));
-  app->appInfo->width = width;
-  app->appInfo->height = height;
+  InputEvent event = {.type = INPUT_RESIZE};
+  event.width = width;
+  event.height = height;
+  input_queue_push(&app->inputQueue, event);
+}
+
+void window_refresh_callback(GLFWwindow *window) {
+  GLCall(GameApp *app = (GameApp *)glfwGetWindowUserPointer(window));
+  game_app_request_redraw(app);
+}
+
+void cursor_pos_callback(GLFWwindow *window, double x, double y) {
+  GLCall(GameApp *app = (GameApp *)glfwGetWindowUserPointer(window));
+  InputEvent event = {.type = INPUT_MOUSE_MOVE};
+  event.x = (float)x;
+  event.y = (float)y;
+  input_queue_push(&app->inputQueue, event);
+}
+
+void scroll_callback(GLFWwindow *window, double x, double y) {
+  GLCall(GameApp *app = (GameApp *)glfwGetWindowUserPointer(window));
+  InputEvent event = {.type = INPUT_SCROLL};
+  event.x = (float)x;
+  event.y = (float)y;
+  input_queue_push(&app->inputQueue, event);
 }
 
 void mouse_button_callback(GLFWwindow *window, int button, int action,
                            int mods) {
   GLCall(GameApp *app = (GameApp *)glfwGetWindowUserPointer(window));
-  if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
-    // TODO: Left Mouse callback in Engine
-  } else if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE) {
-    // TODO:
-  }
-
-  // NOTE: If needed handle right button
+  InputEvent event = {.type = INPUT_MOUSE_BUTTON,
+                      .action = (uint8_t)action,
+                      .mods = (uint16_t)mods,
+                      .code = button};
+  input_queue_push(&app->inputQueue, event);
 }
@@ -1,10 +1,77 @@
 #pragma once
+#include "../assets/assets.h"
+#include "../input/input.h"
+#include "../input/record.h"
+#include "../jobs/jobs.h"
+#include "../profiler/gpu_profiler.h"
+#include "../profiler/profiler.h"
+#include "../renderer/buffer_ring.h"
+#include "../renderer/capture.h"
+#include "../renderer/geometry_pool.h"
+#include "../renderer/gl_state.h"
+#include "../renderer/path_renderer.h"
+#include "../renderer/shader.h"
+#include "../renderer/text_renderer.h"
 #include "../utils/utils.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <math.h>
+#include <stdbool.h>
+#include <time.h>
 
 typedef struct {
   int width;
   int height;
   const char *font_path;
+  const char *shaderCachePath; // NULL disables the program binary cache
+
+  // Headless: offscreen EGL context rendering into an FBO, no window and no
+  // display needed. Runs headlessFrames frames then quits. When dumpPath is
+  // set (printf pattern taking the frame index as int, e.g.
+  // "frames/%04d.ppm", see frame_pattern_valid) every dumpEvery-th frame is
+  // written as PPM, 0 dumps only the last frame.
+  bool headless;
+  int headlessFrames;
+  const char *dumpPath;
+  int dumpEvery;
+
+  // recordPath logs every frame's input. replayPath feeds a recording back
+  // headlessly on its fixed timestep, one recorded frame per frame, and
+  // overrides width, height and headlessFrames. timingsPath writes headless
+  // frame times as CSV for comparing runs.
+  const char *recordPath;
+  const char *replayPath;
+  const char *timingsPath;
+
+  // Every frame, windowed or headless: a .y4m stream or a PPM pattern like
+  // dumpPath. Replaces dumpPath when both are set.
+  const char *capturePath;
+
+  // Seconds per frame the main loop spends on asset uploads. packPath
+  // mounts an archive from `./build pack` before anything is loaded.
+  double assetUploadBudget;
+  const char *packPath;
+
+  // Job system threads including the main thread, 0 for one per core
+  int jobWorkers;
+  bool pinThreads;
+
+  // Segments of the animated demo path, 0 draws none
+  int pathSegments;
+
+  // Spinning polygons drawn through the geometry pool, 0 draws none.
+  // directDraws issues one draw call each instead of a multi-draw-indirect.
+  int sceneObjects;
+  bool directDraws;
+
+  // Windowed only: sleep in glfwWaitEventsTimeout and draw a frame only
+  // after input, a finished asset upload, an overlay update or an animation
+  // asking for one
+  bool onDemand;
+
+  // Stream dynamic geometry through an orphaned buffer even where
+  // persistent mapping is available
+  bool orphanBuffers;
 
   double lastTime;
   double currentTime;
@@ -13,9 +80,58 @@ typedef struct {
 
 typedef enum { CONTINUE, QUIT } returnCode;
 
+// Timestep recordings are made for and replayed at
+#define GAME_APP_FIXED_DT (1.0 / 60.0)
+
 typedef struct {
   GLFWwindow *window;
   GameAppCreateInfo *appInfo;
+  unsigned long frameIndex;
+
+  // Persistent holds the GameApp itself. Frame arenas alternate every frame
+  // and are reset when reused, so frame data lives for two frames.
+  Arena persistent;
+  Arena frameArenas[2];
+  Arena *frameArena;
+
+  // Every dynamic vertex upload goes through here
+  BufferRing stream;
+  TextRenderer text;
+  AssetHandle fontAsset;
+  Capture capture; // --capture, or the headless --dump frames
+  PathRenderer path;
+  GeometryPool scene;
+  int sceneMeshes;
+  char overlayText[128];
+
+  // Filled by the GLFW callbacks, drained at the start of every tick
+  InputQueue inputQueue;
+  InputState input;
+  bool quitRequested;
+  bool redraw; // on demand: the next frame has to be drawn
+
+  InputRecorder recorder;
+  InputReplay replay;
+  bool replaying;
+  FILE *timings;
+
+  // Headless context and its render target
+  EGLDisplay eglDisplay;
+  EGLContext eglContext;
+  GLuint fbo;
+  GLuint colorRenderbuffer;
+  GLuint depthRenderbuffer;
+
+  // Headless frame time statistics, in seconds
+  double startTime;
+  double frameStart;
+  double frameTimeTotal;
+  double frameTimeMin;
+  double frameTimeMax;
+
+#ifdef PROFILER_ENABLED
+  GpuProfiler gpuProfiler;
+#endif
 
   // Engine *engine;
   // Renderer *renderer;
@@ -23,12 +139,24 @@ typedef struct {
 
 GameApp *game_app_create(GameAppCreateInfo *createInfo);
 returnCode game_app_main_loop(GameApp *app);
+returnCode headless_end_frame(GameApp *app);
 void game_app_destroy(GameApp *app);
 GLFWwindow *make_window(int width, int height);
+int make_headless_context(GameApp *app);
+void destroy_headless_context(GameApp *app);
+double game_app_get_time(GameApp *app);
+void game_app_process_input(GameApp *app);
+void game_app_request_redraw(GameApp *app);
+bool game_app_decode_font(Asset *asset);
+bool game_app_upload_font(Asset *asset);
 
-// Callbacks
+// Callbacks, these only push into app->inputQueue
 void calculate_frame_rate(GameApp *app);
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
+// Sets app->redraw directly, there is no input to queue
+void window_refresh_callback(GLFWwindow *window);
+void cursor_pos_callback(GLFWwindow *window, double x, double y);
+void scroll_callback(GLFWwindow *window, double x, double y);
 
 void mouse_button_callback(GLFWwindow *window, int button, int action,
                            int mods);
@@ -0,0 +1,111 @@
+#include "input.h"
+#include <string.h>
+
+_Static_assert((INPUT_QUEUE_CAPACITY & (INPUT_QUEUE_CAPACITY - 1)) == 0,
+               "INPUT_QUEUE_CAPACITY must be a power of two");
+
+void input_queue_init(InputQueue *q) { memset(q, 0, sizeof(*q)); }
+
+static bool input_queue_enqueue(InputQueue *q, const InputEvent *event) {
+  size_t tail = q->tail;
+  size_t head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+  if (tail - head == INPUT_QUEUE_CAPACITY)
+    return false;
+  q->events[tail & (INPUT_QUEUE_CAPACITY - 1)] = *event;
+  __atomic_store_n(&q->tail, tail + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+void input_queue_flush(InputQueue *q) {
+  for (int type = 0; type < INPUT_EVENT_TYPE_COUNT; ++type) {
+    // A full queue keeps the event pending until the next flush
+    if (q->has_pending[type] && input_queue_enqueue(q, &q->pending[type]))
+      q->has_pending[type] = false;
+  }
+}
+
+void input_queue_push(InputQueue *q, InputEvent event) {
+  switch ((InputEventType)event.type) {
+  case INPUT_MOUSE_MOVE:
+  case INPUT_RESIZE:
+    if (q->has_pending[event.type])
+      q->coalesced++;
+    q->pending[event.type] = event;
+    q->has_pending[event.type] = true;
+    return;
+  case INPUT_SCROLL:
+    if (q->has_pending[INPUT_SCROLL]) {
+      q->coalesced++;
+      q->pending[INPUT_SCROLL].x += event.x;
+      q->pending[INPUT_SCROLL].y += event.y;
+    } else {
+      q->pending[INPUT_SCROLL] = event;
+      q->has_pending[INPUT_SCROLL] = true;
+    }
+    return;
+  case INPUT_KEY:
+  case INPUT_MOUSE_BUTTON:
+  case INPUT_EVENT_TYPE_COUNT:
+    break;
+  }
+
+  // A click has to see the cursor position it happened at
+  input_queue_flush(q);
+  if (!input_queue_enqueue(q, &event))
+    q->dropped++;
+}
+
+bool input_queue_pop(InputQueue *q, InputEvent *event) {
+  size_t head = q->head;
+  size_t tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+  if (head == tail)
+    return false;
+  *event = q->events[head & (INPUT_QUEUE_CAPACITY - 1)];
+  __atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+void input_state_begin_tick(InputState *s) {
+  memset(s->keys_pressed, 0, sizeof(s->keys_pressed));
+  s->buttons_pressed = 0;
+  s->buttons_released = 0;
+  s->scroll_x = 0;
+  s->scroll_y = 0;
+  s->resized = false;
+}
+
+void input_state_apply(InputState *s, const InputEvent *event) {
+  switch ((InputEventType)event->type) {
+  case INPUT_KEY:
+    if (event->code >= 0 && event->code < INPUT_KEY_COUNT) {
+      s->keys[event->code] = event->action != INPUT_RELEASE;
+      if (event->action == INPUT_PRESS)
+        s->keys_pressed[event->code] = true;
+    }
+    break;
+  case INPUT_MOUSE_BUTTON:
+    if (event->code >= 0 && event->code < INPUT_BUTTON_COUNT) {
+      s->buttons[event->code] = event->action != INPUT_RELEASE;
+      if (event->action == INPUT_PRESS)
+        s->buttons_pressed |= 1u << event->code;
+      else if (event->action == INPUT_RELEASE)
+        s->buttons_released |= 1u << event->code;
+    }
+    break;
+  case INPUT_MOUSE_MOVE:
+    s->mouse_x = event->x;
+    s->mouse_y = event->y;
+    break;
+  case INPUT_SCROLL:
+    s->scroll_x += event->x;
+    s->scroll_y += event->y;
+    break;
+  case INPUT_RESIZE:
+    s->width = event->width;
+    s->height = event->height;
+    s->resized = true;
+    break;
+  case INPUT_EVENT_TYPE_COUNT:
+    break;
+  }
+}
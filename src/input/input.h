@@ -0,0 +1,91 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Window input as compact events in a single-producer/single-consumer ring.
+//
+// The window thread pushes from the GLFW callbacks and the engine drains the
+// queue at the start of its tick, so the two may run on different threads.
+// Mouse moves, scrolls and resizes are coalesced on the producer side: the
+// latest one is held back and only pushed when another kind of event arrives
+// or on input_queue_flush, which the window thread calls after polling. A
+// high-rate mouse costs one event per poll instead of one per report.
+
+#ifndef INPUT_QUEUE_CAPACITY
+#define INPUT_QUEUE_CAPACITY 1024 // power of two
+#endif
+
+#define INPUT_KEY_COUNT 512
+#define INPUT_BUTTON_COUNT 8
+
+typedef enum {
+  INPUT_KEY,
+  INPUT_MOUSE_BUTTON,
+  INPUT_MOUSE_MOVE,
+  INPUT_SCROLL,
+  INPUT_RESIZE,
+  INPUT_EVENT_TYPE_COUNT,
+} InputEventType;
+
+// GLFW_RELEASE / GLFW_PRESS / GLFW_REPEAT
+typedef enum {
+  INPUT_RELEASE,
+  INPUT_PRESS,
+  INPUT_REPEAT,
+} InputAction;
+
+typedef struct {
+  uint8_t type;   // InputEventType
+  uint8_t action; // InputAction, key and mouse button only
+  uint16_t mods;
+  int32_t code; // key or mouse button
+  union {
+    struct {
+      float x, y; // cursor position or scroll offset
+    };
+    struct {
+      int32_t width, height;
+    };
+  };
+} InputEvent;
+
+typedef struct {
+  _Alignas(64) size_t head; // written by the consumer
+  _Alignas(64) size_t tail; // written by the producer
+
+  // Producer-only state
+  _Alignas(64) InputEvent pending[INPUT_EVENT_TYPE_COUNT];
+  bool has_pending[INPUT_EVENT_TYPE_COUNT];
+  size_t dropped;
+  size_t coalesced;
+
+  InputEvent events[INPUT_QUEUE_CAPACITY];
+} InputQueue;
+
+// Snapshot of the input the engine has consumed so far
+typedef struct {
+  bool keys[INPUT_KEY_COUNT];
+  bool buttons[INPUT_BUTTON_COUNT];
+  float mouse_x, mouse_y;
+  int width, height;
+
+  // Edges and accumulators, cleared by input_state_begin_tick
+  bool keys_pressed[INPUT_KEY_COUNT];
+  uint32_t buttons_pressed; // bit per button
+  uint32_t buttons_released;
+  float scroll_x, scroll_y;
+  bool resized;
+} InputState;
+
+void input_queue_init(InputQueue *q);
+
+// Producer
+void input_queue_push(InputQueue *q, InputEvent event);
+void input_queue_flush(InputQueue *q);
+
+// Consumer
+bool input_queue_pop(InputQueue *q, InputEvent *event);
+
+void input_state_begin_tick(InputState *s);
+void input_state_apply(InputState *s, const InputEvent *event);
@@ -0,0 +1,113 @@
+#include "record.h"
+#include <math.h>
+#include <string.h>
+#include <sys/stat.h>
+
+_Static_assert(sizeof(InputEvent) == 16, "recorded event layout changed");
+
+bool input_recorder_open(InputRecorder *r, const char *path, int width,
+                         int height, double dt) {
+  memset(r, 0, sizeof(*r));
+  r->file = fopen(path, "wb");
+  if (!r->file) {
+    fprintf(stderr, "Could not open recording `%s`\n", path);
+    return false;
+  }
+  InputRecordHeader header = {
+      .magic = INPUT_RECORD_MAGIC,
+      .version = INPUT_RECORD_VERSION,
+      .width = (uint32_t)width,
+      .height = (uint32_t)height,
+      .dt = dt,
+  };
+  fwrite(&header, sizeof(header), 1, r->file);
+  return true;
+}
+
+void input_recorder_frame(InputRecorder *r, double time,
+                          const InputEvent *events, size_t count) {
+  if (!r->file)
+    return;
+  InputRecordFrame frame = {.count = (uint32_t)count, .time = time};
+  fwrite(&frame, sizeof(frame), 1, r->file);
+  fwrite(events, sizeof(*events), count, r->file);
+  r->frames++;
+  r->events += count;
+}
+
+void input_recorder_close(InputRecorder *r) {
+  if (!r->file)
+    return;
+  if (fclose(r->file) != 0)
+    fprintf(stderr, "Could not finish recording\n");
+  r->file = NULL;
+}
+
+bool input_replay_open(InputReplay *r, Arena *arena, const char *path) {
+  memset(r, 0, sizeof(*r));
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    fprintf(stderr, "Could not open recording `%s`\n", path);
+    return false;
+  }
+  // fopen also opens directories, and ftell there is no file size
+  struct stat st;
+  if (fstat(fileno(f), &st) != 0 || !S_ISREG(st.st_mode) ||
+      st.st_size < (off_t)sizeof(InputRecordHeader)) {
+    fprintf(stderr, "Invalid recording `%s`\n", path);
+    fclose(f);
+    return false;
+  }
+
+  size_t size = (size_t)st.st_size;
+  unsigned char *data = (unsigned char *)arena_alloc(arena, size);
+  bool ok = fread(data, 1, size, f) == size;
+  fclose(f);
+  if (ok) {
+    memcpy(&r->header, data, sizeof(r->header));
+    const InputRecordHeader *h = &r->header;
+    ok = h->magic == INPUT_RECORD_MAGIC &&
+         h->version == INPUT_RECORD_VERSION && isfinite(h->dt) && h->dt > 0 &&
+         h->width > 0 && h->width <= INPUT_RECORD_MAX_SIZE &&
+         h->height > 0 && h->height <= INPUT_RECORD_MAX_SIZE;
+  }
+  if (!ok) {
+    fprintf(stderr, "Invalid recording `%s`\n", path);
+    return false;
+  }
+  r->data = data;
+  r->size = size;
+  r->cursor = sizeof(InputRecordHeader);
+
+  // Count frames now so a truncated file fails here, not mid-run
+  for (size_t at = r->cursor; at < r->size; r->frames++) {
+    InputRecordFrame frame;
+    if (r->size - at < sizeof(frame)) {
+      fprintf(stderr, "Truncated recording `%s`\n", path);
+      return false;
+    }
+    memcpy(&frame, r->data + at, sizeof(frame));
+    at += sizeof(frame);
+    if ((r->size - at) / sizeof(InputEvent) < frame.count) {
+      fprintf(stderr, "Truncated recording `%s`\n", path);
+      return false;
+    }
+    at += frame.count * sizeof(InputEvent);
+  }
+  return true;
+}
+
+bool input_replay_next(InputReplay *r, double *time, const InputEvent **events,
+                       size_t *count) {
+  if (r->cursor >= r->size)
+    return false;
+  InputRecordFrame frame;
+  memcpy(&frame, r->data + r->cursor, sizeof(frame));
+  r->cursor += sizeof(frame);
+  // Header and frame records are word multiples, so events stay aligned
+  *events = (const InputEvent *)(r->data + r->cursor);
+  *count = frame.count;
+  *time = frame.time;
+  r->cursor += frame.count * sizeof(InputEvent);
+  return true;
+}
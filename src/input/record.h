@@ -0,0 +1,61 @@
+#pragma once
+#include "../utils/memory.h"
+#include "input.h"
+#include <stdio.h>
+
+// Input recordings for reproducible runs.
+//
+// A recording is a header followed by one record per frame: the frame's
+// timestamp and the InputEvents consumed in that frame, in order. Replaying
+// feeds the same events to the same frames on a fixed timestep, so a replay
+// is independent of how fast the machine runs it and two builds can be
+// compared frame by frame on the same workload.
+//
+//   header   u32 magic, u32 version, u32 width, u32 height, f64 dt
+//   frame    u32 event count, u32 reserved, f64 time, InputEvent[count]
+
+#define INPUT_RECORD_MAGIC 0x43524e49u // "INRC"
+#define INPUT_RECORD_VERSION 1
+// Replays size the framebuffer from the header before any GL context exists
+// to ask for GL_MAX_RENDERBUFFER_SIZE, larger sizes are rejected
+#define INPUT_RECORD_MAX_SIZE 16384
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  double dt; // timestep replays run at
+} InputRecordHeader;
+
+typedef struct {
+  uint32_t count;
+  uint32_t reserved;
+  double time; // seconds since the recording started
+} InputRecordFrame;
+
+typedef struct {
+  FILE *file;
+  size_t frames;
+  size_t events;
+} InputRecorder;
+
+typedef struct {
+  InputRecordHeader header;
+  const unsigned char *data; // whole file, allocated from the caller's arena
+  size_t size;
+  size_t cursor;
+  size_t frames;
+} InputReplay;
+
+bool input_recorder_open(InputRecorder *r, const char *path, int width,
+                         int height, double dt);
+void input_recorder_frame(InputRecorder *r, double time,
+                          const InputEvent *events, size_t count);
+void input_recorder_close(InputRecorder *r);
+
+// Loads and validates the whole recording up front
+bool input_replay_open(InputReplay *r, Arena *arena, const char *path);
+// Events of the next frame, false once the recording is exhausted
+bool input_replay_next(InputReplay *r, double *time, const InputEvent **events,
+                       size_t *count);
@@ -0,0 +1,359 @@
+#define _GNU_SOURCE
+#include "jobs.h"
+#include "../profiler/profiler.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+_Static_assert((JOB_DEQUE_CAPACITY & (JOB_DEQUE_CAPACITY - 1)) == 0,
+               "JOB_DEQUE_CAPACITY must be a power of two");
+
+#if defined(__x86_64__) || defined(__i386__)
+#define jobs_pause() __builtin_ia32_pause()
+#else
+#define jobs_pause() sched_yield()
+#endif
+
+// Failed find attempts before an idle worker goes to sleep
+#define JOBS_SPIN_COUNT 256
+
+typedef struct {
+  _Alignas(64) int64_t top;   // stolen from, any thread
+  _Alignas(64) int64_t bottom; // owner only
+  Job jobs[JOB_DEQUE_CAPACITY];
+} JobDeque;
+
+typedef struct {
+  JobDeque deque;
+  pthread_t thread;
+  int index;
+  uint32_t rng; // victim selection
+} JobWorker;
+
+static struct {
+  Arena arena;
+  JobWorker *workers;
+  int count;
+  bool pin;
+  bool quit;
+
+  // Submissions from threads outside the system
+  pthread_mutex_t inject_lock;
+  Job inject[JOB_DEQUE_CAPACITY];
+  size_t inject_head;
+  size_t inject_tail;
+
+  // Sleeping workers, woken when the epoch moves
+  pthread_mutex_t sleep_lock;
+  pthread_cond_t wake;
+  uint64_t epoch;
+  int sleepers;
+} jobs = {
+    .inject_lock = PTHREAD_MUTEX_INITIALIZER,
+    .sleep_lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+};
+
+static __thread JobWorker *jobs_self = NULL;
+static char jobs_thread_names[JOB_MAX_WORKERS][24];
+
+// Chase-Lev, following the C11 formulation of Lê et al. (PPoPP'13). Jobs are
+// copied by value; a thief's copy is only used once its CAS on top
+// succeeds, and the owner never reuses a slot between top and bottom.
+static bool job_deque_push(JobDeque *d, const Job *job) {
+  int64_t b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED);
+  int64_t t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+  if (b - t >= JOB_DEQUE_CAPACITY)
+    return false;
+  d->jobs[b & (JOB_DEQUE_CAPACITY - 1)] = *job;
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+  return true;
+}
+
+static bool job_deque_pop(JobDeque *d, Job *job) {
+  int64_t b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED) - 1;
+  __atomic_store_n(&d->bottom, b, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  int64_t t = __atomic_load_n(&d->top, __ATOMIC_RELAXED);
+  if (t > b) {
+    __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+    return false;
+  }
+  *job = d->jobs[b & (JOB_DEQUE_CAPACITY - 1)];
+  if (t == b) {
+    // Last job, race the thieves for it
+    bool won = __atomic_compare_exchange_n(&d->top, &t, t + 1, false,
+                                           __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+    __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+    return won;
+  }
+  return true;
+}
+
+static bool job_deque_steal(JobDeque *d, Job *job) {
+  int64_t t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  int64_t b = __atomic_load_n(&d->bottom, __ATOMIC_ACQUIRE);
+  if (t >= b)
+    return false;
+  *job = d->jobs[t & (JOB_DEQUE_CAPACITY - 1)];
+  return __atomic_compare_exchange_n(&d->top, &t, t + 1, false,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+static bool job_deque_empty(JobDeque *d) {
+  return __atomic_load_n(&d->bottom, __ATOMIC_RELAXED) <=
+         __atomic_load_n(&d->top, __ATOMIC_RELAXED);
+}
+
+static void jobs_notify(void) {
+  __atomic_add_fetch(&jobs.epoch, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&jobs.sleepers, __ATOMIC_SEQ_CST) > 0) {
+    pthread_mutex_lock(&jobs.sleep_lock);
+    pthread_cond_signal(&jobs.wake);
+    pthread_mutex_unlock(&jobs.sleep_lock);
+  }
+}
+
+static void jobs_execute(const Job *job);
+
+static void jobs_push(const Job *job) {
+  JobWorker *self = jobs_self;
+  if (self) {
+    if (!job_deque_push(&self->deque, job)) {
+      jobs_execute(job); // full, nobody is keeping up anyway
+      return;
+    }
+  } else {
+    pthread_mutex_lock(&jobs.inject_lock);
+    bool full = jobs.inject_tail - jobs.inject_head == JOB_DEQUE_CAPACITY;
+    if (!full) {
+      jobs.inject[jobs.inject_tail & (JOB_DEQUE_CAPACITY - 1)] = *job;
+      __atomic_store_n(&jobs.inject_tail, jobs.inject_tail + 1,
+                       __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&jobs.inject_lock);
+    if (full) {
+      jobs_execute(job);
+      return;
+    }
+  }
+  jobs_notify();
+}
+
+// The indexes only change under the lock, but are stored atomically so the
+// emptiness check can skip the lock
+static bool jobs_take_injected(Job *job) {
+  if (__atomic_load_n(&jobs.inject_head, __ATOMIC_ACQUIRE) ==
+      __atomic_load_n(&jobs.inject_tail, __ATOMIC_ACQUIRE))
+    return false;
+  pthread_mutex_lock(&jobs.inject_lock);
+  bool found = jobs.inject_head != jobs.inject_tail;
+  if (found) {
+    *job = jobs.inject[jobs.inject_head & (JOB_DEQUE_CAPACITY - 1)];
+    __atomic_store_n(&jobs.inject_head, jobs.inject_head + 1,
+                     __ATOMIC_RELEASE);
+  }
+  pthread_mutex_unlock(&jobs.inject_lock);
+  return found;
+}
+
+static bool jobs_find(JobWorker *self, Job *job) {
+  if (self && job_deque_pop(&self->deque, job))
+    return true;
+  if (jobs_take_injected(job))
+    return true;
+
+  // xorshift32, any start is fine as long as workers don't all pick 0
+  uint32_t r = self ? self->rng : (uint32_t)(uintptr_t)job;
+  r ^= r << 13;
+  r ^= r >> 17;
+  r ^= r << 5;
+  if (self)
+    self->rng = r;
+  for (int i = 0; i < jobs.count; ++i) {
+    JobWorker *victim = &jobs.workers[(r + i) % jobs.count];
+    if (victim != self && job_deque_steal(&victim->deque, job))
+      return true;
+  }
+  return false;
+}
+
+static void jobs_execute(const Job *job) {
+  PROFILE_ZONE("job");
+  if (job->grain == 0) {
+    job->func(job->data, job->begin, job->end);
+  } else {
+    Job range = *job;
+    JobWorker *self = jobs_self;
+    while (range.begin < range.end) {
+      size_t size = range.end - range.begin;
+      if (size > 2 * range.grain && self && job_deque_empty(&self->deque)) {
+        Job right = range;
+        right.begin = range.begin + size / 2;
+        range.end = right.begin;
+        __atomic_add_fetch(&range.counter->pending, 1, __ATOMIC_RELAXED);
+        jobs_push(&right);
+        continue;
+      }
+      size_t end = range.begin + range.grain;
+      if (end > range.end)
+        end = range.end;
+      range.func(range.data, range.begin, end);
+      range.begin = end;
+    }
+  }
+  if (job->counter)
+    __atomic_sub_fetch(&job->counter->pending, 1, __ATOMIC_RELEASE);
+}
+
+static void jobs_pin(int index) {
+#ifdef __linux__
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(index % (cores > 0 ? cores : 1), &set);
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+    fprintf(stderr, "Could not pin job worker %d\n", index);
+#else
+  (void)index; // no affinity API worth using outside Linux
+#endif
+}
+
+static void *jobs_worker_main(void *arg) {
+  JobWorker *self = (JobWorker *)arg;
+  jobs_self = self;
+  PROFILE_THREAD_NAME(jobs_thread_names[self->index]);
+  if (jobs.pin)
+    jobs_pin(self->index);
+
+  int idle = 0;
+  while (!__atomic_load_n(&jobs.quit, __ATOMIC_ACQUIRE)) {
+    uint64_t epoch = __atomic_load_n(&jobs.epoch, __ATOMIC_SEQ_CST);
+    Job job;
+    if (jobs_find(self, &job)) {
+      jobs_execute(&job);
+      idle = 0;
+      continue;
+    }
+    if (++idle < JOBS_SPIN_COUNT) {
+      jobs_pause();
+      continue;
+    }
+
+    pthread_mutex_lock(&jobs.sleep_lock);
+    __atomic_add_fetch(&jobs.sleepers, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&jobs.epoch, __ATOMIC_SEQ_CST) == epoch &&
+        !__atomic_load_n(&jobs.quit, __ATOMIC_ACQUIRE))
+      pthread_cond_wait(&jobs.wake, &jobs.sleep_lock);
+    __atomic_sub_fetch(&jobs.sleepers, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&jobs.sleep_lock);
+    idle = 0;
+  }
+  return NULL;
+}
+
+bool jobs_init(int workers, bool pin) {
+  if (workers <= 0) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    workers = cores > 0 ? (int)cores : 1;
+  }
+  if (workers > JOB_MAX_WORKERS)
+    workers = JOB_MAX_WORKERS;
+
+  jobs.workers = (JobWorker *)arena_alloc_aligned(
+      &jobs.arena, workers * sizeof(JobWorker), _Alignof(JobWorker));
+  memset(jobs.workers, 0, workers * sizeof(JobWorker));
+  jobs.count = workers;
+  jobs.pin = pin;
+  jobs.quit = false;
+
+  for (int i = 0; i < workers; ++i) {
+    JobWorker *w = &jobs.workers[i];
+    w->index = i;
+    w->rng = 0x9e3779b9u * (i + 1);
+    snprintf(jobs_thread_names[i], sizeof(jobs_thread_names[i]), "worker %d",
+             i);
+  }
+
+  jobs_self = &jobs.workers[0];
+  if (pin)
+    jobs_pin(0);
+  for (int i = 1; i < workers; ++i) {
+    if (pthread_create(&jobs.workers[i].thread, NULL, jobs_worker_main,
+                       &jobs.workers[i]) != 0) {
+      fprintf(stderr, "Could not start job worker %d\n", i);
+      jobs.count = i;
+      break;
+    }
+  }
+  return true;
+}
+
+void jobs_shutdown(void) {
+  if (!jobs.workers)
+    return;
+  pthread_mutex_lock(&jobs.sleep_lock);
+  __atomic_store_n(&jobs.quit, true, __ATOMIC_RELEASE);
+  pthread_cond_broadcast(&jobs.wake);
+  pthread_mutex_unlock(&jobs.sleep_lock);
+  for (int i = 1; i < jobs.count; ++i)
+    pthread_join(jobs.workers[i].thread, NULL);
+
+  jobs_self = NULL;
+  jobs.workers = NULL;
+  jobs.count = 0;
+  arena_free(&jobs.arena);
+}
+
+int jobs_worker_count(void) { return jobs.count; }
+
+int jobs_worker_index(void) { return jobs_self ? jobs_self->index : -1; }
+
+void jobs_run(JobFunc *func, void *data, size_t count, JobCounter *counter) {
+  if (jobs.count <= 1) {
+    for (size_t i = 0; i < count; ++i)
+      func(data, i, i + 1);
+    return;
+  }
+  __atomic_add_fetch(&counter->pending, (int64_t)count, __ATOMIC_RELAXED);
+  for (size_t i = 0; i < count; ++i) {
+    Job job = {.func = func, .data = data, .begin = i, .end = i + 1,
+               .counter = counter};
+    jobs_push(&job);
+  }
+}
+
+void jobs_wait(JobCounter *counter) {
+  PROFILE_FUNCTION();
+  while (__atomic_load_n(&counter->pending, __ATOMIC_ACQUIRE) > 0) {
+    Job job;
+    if (jobs_find(jobs_self, &job)) {
+      jobs_execute(&job);
+    } else {
+      jobs_pause();
+    }
+  }
+}
+
+void parallel_for(JobFunc *func, void *data, size_t count, size_t grain) {
+  if (grain == 0)
+    grain = 1;
+  if (jobs.count <= 1 || count <= grain) {
+    func(data, 0, count);
+    return;
+  }
+  JobCounter counter = {.pending = 1};
+  Job job = {.func = func, .data = data, .begin = 0, .end = count,
+             .grain = grain, .counter = &counter};
+  // Outside the system there is no deque to split into, let a worker start
+  if (jobs_self) {
+    jobs_execute(&job);
+  } else {
+    jobs_push(&job);
+  }
+  jobs_wait(&counter);
+}
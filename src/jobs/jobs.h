@@ -0,0 +1,61 @@
+#pragma once
+#include "../utils/memory.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Work-stealing job system, the one scheduler every subsystem submits to.
+//
+// Each worker owns a Chase-Lev deque: it pushes and pops at the bottom, idle
+// workers steal from the top of a random victim. The thread calling
+// jobs_init is worker 0 and runs jobs only while it waits in jobs_wait.
+// Threads outside the system (IO threads, ...) submit through a shared
+// injection queue.
+//
+// Fork/join goes through JobCounter: jobs_run adds the jobs to the counter,
+// each finished job takes one off, and jobs_wait runs other jobs until it
+// reaches zero. Counters are plain values owned by the caller, e.g.
+//
+//   JobCounter counter = {0};
+//   jobs_run(rasterize_glyph, glyphs, glyph_count, &counter);
+//   jobs_wait(&counter);
+//
+// parallel_for splits ranges lazily: a worker keeps taking `grain` sized
+// chunks off its range and only splits the rest in half while its own deque
+// is empty, so a range stays one job unless other workers are idle to steal.
+
+#ifndef JOB_DEQUE_CAPACITY
+#define JOB_DEQUE_CAPACITY 4096 // power of two
+#endif
+
+#define JOB_MAX_WORKERS 64
+
+// Runs items [begin, end) of `data`
+typedef void JobFunc(void *data, size_t begin, size_t end);
+
+typedef struct {
+  int64_t pending;
+} JobCounter;
+
+typedef struct {
+  JobFunc *func;
+  void *data;
+  size_t begin;
+  size_t end;
+  size_t grain; // parallel_for chunk size, 0 for plain jobs
+  JobCounter *counter;
+} Job;
+
+// `workers` includes the calling thread, 0 picks one per online core. With
+// `pin` worker i is bound to core i.
+bool jobs_init(int workers, bool pin);
+void jobs_shutdown(void);
+int jobs_worker_count(void);
+int jobs_worker_index(void); // -1 on threads outside the system
+
+// func(data, i, i + 1) for every i in [0, count)
+void jobs_run(JobFunc *func, void *data, size_t count, JobCounter *counter);
+void jobs_wait(JobCounter *counter);
+
+// func over [0, count) in chunks of at least `grain` items, returns when done
+void parallel_for(JobFunc *func, void *data, size_t count, size_t grain);
@@ -1,6 +1,9 @@
 #include "control/game_app.h"
 
-int main() {
+int main(int argc, char *argv[]) {
+  PROFILE_INIT();
+  PROFILE_THREAD_NAME("main");
+
   int width = 960;
   int height = 540;
 
@@ -8,8 +11,55 @@ int main() {
   appInfo.width = width;
   appInfo.height = height;
   appInfo.font_path = "assets/fonts/ProtoNerdFont.ttf";
+  appInfo.shaderCachePath = "shader_cache";
+  appInfo.assetUploadBudget = 0.002;
+
+  // --headless <frames> [--dump <pattern>] [--dump-every <n>]
+  // --record <file> | --replay <file>, --timings <csv>, --capture <path>
+  // --jobs <workers> [--pin], --pack <archive>, --path-segments <n>
+  // --on-demand, --orphan-buffers, --scene-objects <n> [--direct-draws]
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--headless") == 0 && i + 1 < argc) {
+      appInfo.headless = true;
+      appInfo.headlessFrames = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+      appInfo.dumpPath = argv[++i];
+    } else if (strcmp(argv[i], "--dump-every") == 0 && i + 1 < argc) {
+      appInfo.dumpEvery = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+      appInfo.recordPath = argv[++i];
+    } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+      appInfo.replayPath = argv[++i];
+    } else if (strcmp(argv[i], "--timings") == 0 && i + 1 < argc) {
+      appInfo.timingsPath = argv[++i];
+    } else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+      appInfo.capturePath = argv[++i];
+    } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+      appInfo.jobWorkers = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--pin") == 0) {
+      appInfo.pinThreads = true;
+    } else if (strcmp(argv[i], "--pack") == 0 && i + 1 < argc) {
+      appInfo.packPath = argv[++i];
+    } else if (strcmp(argv[i], "--path-segments") == 0 && i + 1 < argc) {
+      appInfo.pathSegments = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--on-demand") == 0) {
+      appInfo.onDemand = true;
+    } else if (strcmp(argv[i], "--orphan-buffers") == 0) {
+      appInfo.orphanBuffers = true;
+    } else if (strcmp(argv[i], "--scene-objects") == 0 && i + 1 < argc) {
+      appInfo.sceneObjects = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--direct-draws") == 0) {
+      appInfo.directDraws = true;
+    } else {
+      fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+      return 1;
+    }
+  }
 
   GameApp *app = game_app_create(&appInfo);
+  if (!app) {
+    return 1;
+  }
 
   returnCode nextAction = CONTINUE;
   while (nextAction == CONTINUE) {
@@ -18,5 +68,8 @@ int main() {
 
   game_app_destroy(app);
 
+  PROFILE_DUMP("trace.json");
+  PROFILE_SHUTDOWN();
+
   return 0;
 }
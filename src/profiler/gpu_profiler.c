@@ -0,0 +1,122 @@
+#include "gpu_profiler.h"
+
+#ifdef PROFILER_ENABLED
+
+static void gpu_profiler_calibrate(GpuProfiler *p) {
+  GLint64 gpu_ns = 0;
+  GLCall(glGetInteger64v(GL_TIMESTAMP, &gpu_ns));
+  p->offset_ns = (int64_t)profile_clock_ns() - (int64_t)gpu_ns;
+}
+
+void gpu_profiler_init(GpuProfiler *p) {
+  memset(p, 0, sizeof(*p));
+  for (int i = 0; i < GPU_PROFILER_FRAMES; ++i) {
+    GLCall(glGenQueries(GPU_PROFILER_MAX_ZONES * 2, p->frames[i].queries));
+  }
+  p->track = profile_track_create("GPU");
+  gpu_profiler_calibrate(p);
+}
+
+void gpu_profiler_destroy(GpuProfiler *p) {
+  for (int i = 0; i < GPU_PROFILER_FRAMES; ++i) {
+    GLCall(glDeleteQueries(GPU_PROFILER_MAX_ZONES * 2, p->frames[i].queries));
+  }
+}
+
+// Reads back a finished frame. Returns false without blocking if the GPU has
+// not reached the frame's last query yet.
+static bool gpu_profiler_resolve(GpuProfiler *p, GpuProfilerFrame *f) {
+  if (f->count == 0) {
+    f->pending = false;
+    return true;
+  }
+
+  // The frame zone is closed last, queries complete in submission order.
+  GLuint available = 0;
+  GLCall(glGetQueryObjectuiv(f->queries[1], GL_QUERY_RESULT_AVAILABLE,
+                             &available));
+  if (!available)
+    return false;
+
+  for (uint32_t i = 0; i < f->count; ++i) {
+    GLuint64 begin = 0, end = 0;
+    GLCall(glGetQueryObjectui64v(f->queries[i * 2], GL_QUERY_RESULT, &begin));
+    GLCall(glGetQueryObjectui64v(f->queries[i * 2 + 1], GL_QUERY_RESULT, &end));
+    profile_track_emit(p->track, f->names[i], begin + f->offset_ns,
+                       end + f->offset_ns);
+    if (i == 0)
+      p->last_frame_ms = (double)(end - begin) / 1e6;
+  }
+
+  f->pending = false;
+  return true;
+}
+
+void gpu_profiler_begin_frame(GpuProfiler *p) {
+  // Drain completed frames oldest first, stop at the first one still in
+  // flight.
+  uint64_t oldest =
+      p->frame >= GPU_PROFILER_FRAMES ? p->frame - GPU_PROFILER_FRAMES : 0;
+  for (uint64_t i = oldest; i < p->frame; ++i) {
+    GpuProfilerFrame *f = &p->frames[i % GPU_PROFILER_FRAMES];
+    if (f->pending && !gpu_profiler_resolve(p, f))
+      break;
+  }
+
+  GpuProfilerFrame *f = &p->frames[p->frame % GPU_PROFILER_FRAMES];
+  if (f->pending) {
+    // GPU is more than GPU_PROFILER_FRAMES behind, reuse the slot instead of
+    // stalling on it.
+    f->pending = false;
+    p->dropped_frames++;
+  }
+
+  if (p->frame % GPU_PROFILER_CALIBRATION_INTERVAL == 0)
+    gpu_profiler_calibrate(p);
+
+  f->count = 0;
+  f->offset_ns = p->offset_ns;
+  p->depth = 0;
+  gpu_profiler_zone_begin(p, "gpu_frame");
+}
+
+void gpu_profiler_end_frame(GpuProfiler *p) {
+  while (p->depth > 0)
+    gpu_profiler_zone_end(p);
+
+  GpuProfilerFrame *f = &p->frames[p->frame % GPU_PROFILER_FRAMES];
+  f->pending = true;
+  p->frame++;
+}
+
+void gpu_profiler_zone_begin(GpuProfiler *p, const char *name) {
+  if (p->depth >= GPU_PROFILER_MAX_DEPTH) {
+    p->depth++; // keep begin/end balanced, zone is not recorded
+    return;
+  }
+
+  GpuProfilerFrame *f = &p->frames[p->frame % GPU_PROFILER_FRAMES];
+  uint32_t index = UINT32_MAX;
+  if (f->count < GPU_PROFILER_MAX_ZONES) {
+    index = f->count++;
+    f->names[index] = name;
+    GLCall(glQueryCounter(f->queries[index * 2], GL_TIMESTAMP));
+  }
+  p->stack[p->depth++] = index;
+}
+
+void gpu_profiler_zone_end(GpuProfiler *p) {
+  if (p->depth == 0)
+    return;
+  p->depth--;
+
+  if (p->depth >= GPU_PROFILER_MAX_DEPTH)
+    return;
+  uint32_t index = p->stack[p->depth];
+  if (index == UINT32_MAX)
+    return;
+  GpuProfilerFrame *f = &p->frames[p->frame % GPU_PROFILER_FRAMES];
+  GLCall(glQueryCounter(f->queries[index * 2 + 1], GL_TIMESTAMP));
+}
+
+#endif // PROFILER_ENABLED
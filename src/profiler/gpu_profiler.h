@@ -0,0 +1,88 @@
+#pragma once
+#include "../utils/utils.h"
+#include "profiler.h"
+
+// GPU profiling zones built on glQueryCounter(GL_TIMESTAMP) pairs.
+//
+// Queries live in a ring of GPU_PROFILER_FRAMES frames. A frame is read back
+// only once GL_QUERY_RESULT_AVAILABLE reports its last query done, so the CPU
+// never waits on the GPU; if the ring wraps before the results arrive the
+// frame is dropped instead. Results are shifted onto CLOCK_MONOTONIC and
+// emitted into a "GPU" track of the CPU trace (profiler.h).
+//
+// Compiled out together with the CPU zones unless PROFILER_ENABLED is set.
+
+#ifndef GPU_PROFILER_FRAMES
+#define GPU_PROFILER_FRAMES 4
+#endif
+
+#ifndef GPU_PROFILER_MAX_ZONES
+#define GPU_PROFILER_MAX_ZONES 64
+#endif
+
+#ifndef GPU_PROFILER_MAX_DEPTH
+#define GPU_PROFILER_MAX_DEPTH 16
+#endif
+
+// Frames between GPU/CPU clock re-synchronizations.
+#ifndef GPU_PROFILER_CALIBRATION_INTERVAL
+#define GPU_PROFILER_CALIBRATION_INTERVAL 600
+#endif
+
+#ifdef PROFILER_ENABLED
+
+typedef struct {
+  GLuint queries[GPU_PROFILER_MAX_ZONES * 2];
+  const char *names[GPU_PROFILER_MAX_ZONES];
+  uint32_t count;
+  int64_t offset_ns; // GPU -> CPU clock offset at the time of recording
+  bool pending;
+} GpuProfilerFrame;
+
+typedef struct {
+  GpuProfilerFrame frames[GPU_PROFILER_FRAMES];
+  uint64_t frame;
+  uint32_t stack[GPU_PROFILER_MAX_DEPTH];
+  uint32_t depth;
+
+  int64_t offset_ns;
+  ProfileThread *track;
+
+  // Telemetry of the most recently resolved frame
+  double last_frame_ms;
+  uint64_t dropped_frames;
+} GpuProfiler;
+
+void gpu_profiler_init(GpuProfiler *p);
+void gpu_profiler_destroy(GpuProfiler *p);
+void gpu_profiler_begin_frame(GpuProfiler *p);
+void gpu_profiler_end_frame(GpuProfiler *p);
+void gpu_profiler_zone_begin(GpuProfiler *p, const char *name);
+void gpu_profiler_zone_end(GpuProfiler *p);
+
+static inline void gpu_profiler_scope_end(GpuProfiler **scope) {
+  gpu_profiler_zone_end(*scope);
+}
+
+#define GPU_PROFILE_INIT(p) gpu_profiler_init(p)
+#define GPU_PROFILE_DESTROY(p) gpu_profiler_destroy(p)
+#define GPU_PROFILE_BEGIN_FRAME(p) gpu_profiler_begin_frame(p)
+#define GPU_PROFILE_END_FRAME(p) gpu_profiler_end_frame(p)
+#define GPU_PROFILE_BEGIN(p, name) gpu_profiler_zone_begin(p, name)
+#define GPU_PROFILE_END(p) gpu_profiler_zone_end(p)
+#define GPU_PROFILE_ZONE(p, name)                                              \
+  GpuProfiler *PROFILE_CONCAT(gpu_profile_scope_, __LINE__)                    \
+      __attribute__((cleanup(gpu_profiler_scope_end), unused)) =               \
+          (gpu_profiler_zone_begin(p, name), (p))
+
+#else
+
+#define GPU_PROFILE_INIT(p) ((void)0)
+#define GPU_PROFILE_DESTROY(p) ((void)0)
+#define GPU_PROFILE_BEGIN_FRAME(p) ((void)0)
+#define GPU_PROFILE_END_FRAME(p) ((void)0)
+#define GPU_PROFILE_BEGIN(p, name) ((void)0)
+#define GPU_PROFILE_END(p) ((void)0)
+#define GPU_PROFILE_ZONE(p, name) ((void)0)
+
+#endif // PROFILER_ENABLED
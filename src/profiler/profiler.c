@@ -0,0 +1,176 @@
+#include "profiler.h"
+
+#ifdef PROFILER_ENABLED
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+__thread ProfileThread *profile_thread = NULL;
+
+static _Atomic(ProfileThread *) profile_threads = NULL;
+static atomic_uint profile_next_tid = 1;
+
+static uint64_t profile_base_ticks = 0;
+static uint64_t profile_base_ns = 0;
+static double profile_ns_per_tick = 0.0;
+
+uint64_t profile_clock_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void profile_init(void) {
+  if (profile_base_ns != 0)
+    return;
+  profile_base_ns = profile_clock_ns();
+  profile_base_ticks = profile_now();
+}
+
+// TSC frequency is measured against CLOCK_MONOTONIC over the lifetime of the
+// run, spinning for a few ms only if the run was shorter than that.
+static void profile_calibrate(void) {
+#ifdef PROFILE_USE_RDTSC
+  uint64_t ns = profile_clock_ns();
+  while (ns - profile_base_ns < 10000000ull)
+    ns = profile_clock_ns();
+  uint64_t ticks = profile_now();
+  profile_ns_per_tick =
+      (double)(ns - profile_base_ns) / (double)(ticks - profile_base_ticks);
+#else
+  profile_ns_per_tick = 1.0;
+#endif
+}
+
+double profile_ticks_to_ns(uint64_t ticks) {
+  if (profile_ns_per_tick == 0.0)
+    profile_calibrate();
+  return (double)(ticks - profile_base_ticks) * profile_ns_per_tick;
+}
+
+// Each thread owns its buffer; registration is a lock-free push onto the
+// global list so the exporter can find it.
+static ProfileThread *profile_thread_alloc(void) {
+  profile_init();
+
+  ProfileThread *t = (ProfileThread *)calloc(1, sizeof(ProfileThread));
+  if (!t) {
+    fprintf(stderr, "Failed to allocate profiler thread buffer\n");
+    abort();
+  }
+  t->tid = atomic_fetch_add(&profile_next_tid, 1);
+
+  ProfileThread *head = atomic_load(&profile_threads);
+  do {
+    t->next = head;
+  } while (!atomic_compare_exchange_weak(&profile_threads, &head, t));
+
+  return t;
+}
+
+ProfileThread *profile_thread_register(void) {
+  profile_thread = profile_thread_alloc();
+  return profile_thread;
+}
+
+ProfileThread *profile_track_create(const char *name) {
+  ProfileThread *t = profile_thread_alloc();
+  t->name = name;
+  t->ns_clock = true;
+  return t;
+}
+
+void profile_track_emit(ProfileThread *track, const char *name,
+                        uint64_t begin_ns, uint64_t end_ns) {
+  ProfileZone *z = &track->zones[track->count & (PROFILE_THREAD_CAPACITY - 1)];
+  z->name = name;
+  z->begin = begin_ns;
+  z->end = end_ns;
+  track->count++;
+}
+
+void profile_thread_name(const char *name) {
+  ProfileThread *t = profile_thread;
+  if (!t)
+    t = profile_thread_register();
+  t->name = name;
+}
+
+// Names are arbitrary strings (asset paths, ...), quote and escape them
+static void profile_write_json_string(FILE *f, const char *s) {
+  fputc('"', f);
+  for (; *s; ++s) {
+    unsigned char c = (unsigned char)*s;
+    if (c == '"' || c == '\\')
+      fprintf(f, "\\%c", c);
+    else if (c < 0x20)
+      fprintf(f, "\\u%04x", c);
+    else
+      fputc(c, f);
+  }
+  fputc('"', f);
+}
+
+// Expects the instrumented threads to be quiescent (exit, frame boundary).
+bool profile_write_chrome_trace(const char *path) {
+  FILE *f = fopen(path, "w");
+  if (!f) {
+    fprintf(stderr, "Failed to open trace file `%s`\n", path);
+    return false;
+  }
+
+  fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  bool first = true;
+  for (ProfileThread *t = atomic_load(&profile_threads); t; t = t->next) {
+    if (t->name) {
+      fprintf(f,
+              "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+              "\"args\":{\"name\":",
+              first ? "" : ",\n", t->tid);
+      profile_write_json_string(f, t->name);
+      fprintf(f, "}}");
+      first = false;
+    }
+
+    uint64_t count = t->count;
+    uint64_t start =
+        count > PROFILE_THREAD_CAPACITY ? count - PROFILE_THREAD_CAPACITY : 0;
+    for (uint64_t i = start; i < count; ++i) {
+      ProfileZone *z = &t->zones[i & (PROFILE_THREAD_CAPACITY - 1)];
+      if (z->end == 0)
+        continue; // still open
+      double ts, dur;
+      if (t->ns_clock) {
+        ts = ((double)z->begin - (double)profile_base_ns) / 1000.0;
+        dur = (double)(z->end - z->begin) / 1000.0;
+      } else {
+        ts = profile_ticks_to_ns(z->begin) / 1000.0;
+        dur = profile_ticks_to_ns(z->end) / 1000.0 - ts;
+      }
+      fprintf(f, "%s{\"name\":", first ? "" : ",\n");
+      profile_write_json_string(f, z->name);
+      fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+              t->tid, ts, dur);
+      first = false;
+    }
+  }
+  fprintf(f, "\n]}\n");
+
+  bool ok = ferror(f) == 0;
+  fclose(f);
+  return ok;
+}
+
+// Call once every instrumented thread has exited.
+void profile_shutdown(void) {
+  ProfileThread *t = atomic_exchange(&profile_threads, NULL);
+  while (t) {
+    ProfileThread *next = t->next;
+    free(t);
+    t = next;
+  }
+  profile_thread = NULL;
+}
+
+#endif // PROFILER_ENABLED
@@ -0,0 +1,143 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Scoped CPU profiling zones exported as a Chrome trace / Perfetto JSON file.
+//
+// Everything here compiles out unless PROFILER_ENABLED is defined
+// (`PROFILE=1 ./build run`). When enabled a zone costs two timestamp reads
+// and a few stores into a thread-local ring, no locks or atomics: tens of
+// nanoseconds per zone (~20 ns with rdtsc on bare metal, ~40 ns under a VM
+// or with the vDSO clock_gettime fallback).
+//
+// Usage:
+//   void f(void) {
+//     PROFILE_FUNCTION();             // closes when f returns
+//     PROFILE_BEGIN("inner");         // explicit begin/end pair
+//     ...
+//     PROFILE_END();
+//   }
+//   PROFILE_DUMP("trace.json");       // open in ui.perfetto.dev
+
+#ifndef PROFILE_THREAD_CAPACITY
+#define PROFILE_THREAD_CAPACITY (64 * 1024) // zones per thread, power of two
+#endif
+
+#ifndef PROFILE_MAX_DEPTH
+#define PROFILE_MAX_DEPTH 64
+#endif
+
+#ifdef PROFILER_ENABLED
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILE_USE_RDTSC 1
+#else
+#include <time.h>
+#endif
+
+typedef struct {
+  const char *name;
+  uint64_t begin;
+  uint64_t end;
+} ProfileZone;
+
+typedef struct ProfileThread ProfileThread;
+struct ProfileThread {
+  ProfileThread *next;
+  const char *name;
+  uint32_t tid;
+  uint32_t depth;
+  bool ns_clock; // track fed with CLOCK_MONOTONIC ns instead of ticks
+  uint64_t count; // zones ever begun; slot is count % capacity
+  uint64_t stack[PROFILE_MAX_DEPTH];
+  ProfileZone zones[PROFILE_THREAD_CAPACITY];
+};
+
+extern __thread ProfileThread *profile_thread;
+
+// Timestamps are raw ticks (TSC or ns); profile_ticks_to_ns converts them.
+static inline uint64_t profile_now(void) {
+#ifdef PROFILE_USE_RDTSC
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void profile_init(void);
+void profile_shutdown(void);
+ProfileThread *profile_thread_register(void);
+void profile_thread_name(const char *name);
+uint64_t profile_clock_ns(void);
+double profile_ticks_to_ns(uint64_t ticks);
+
+// Extra timeline rows for zones measured elsewhere (e.g. GPU queries). A track
+// has a single writer; timestamps are CLOCK_MONOTONIC nanoseconds.
+ProfileThread *profile_track_create(const char *name);
+void profile_track_emit(ProfileThread *track, const char *name,
+                        uint64_t begin_ns, uint64_t end_ns);
+bool profile_write_chrome_trace(const char *path);
+
+static inline void profile_zone_begin(const char *name) {
+  ProfileThread *t = profile_thread;
+  if (!t)
+    t = profile_thread_register();
+  ProfileZone *z = &t->zones[t->count & (PROFILE_THREAD_CAPACITY - 1)];
+  z->name = name;
+  z->end = 0;
+  if (t->depth < PROFILE_MAX_DEPTH)
+    t->stack[t->depth] = t->count;
+  t->depth++;
+  t->count++;
+  z->begin = profile_now();
+}
+
+static inline void profile_zone_end(void) {
+  uint64_t now = profile_now();
+  ProfileThread *t = profile_thread;
+  if (!t || t->depth == 0)
+    return;
+  t->depth--;
+  if (t->depth < PROFILE_MAX_DEPTH) {
+    uint64_t index = t->stack[t->depth];
+    // Overwritten by newer zones while still open: drop it.
+    if (t->count - index <= PROFILE_THREAD_CAPACITY)
+      t->zones[index & (PROFILE_THREAD_CAPACITY - 1)].end = now;
+  }
+}
+
+static inline void profile_scope_end(int *scope) {
+  (void)scope;
+  profile_zone_end();
+}
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#define PROFILE_INIT() profile_init()
+#define PROFILE_SHUTDOWN() profile_shutdown()
+#define PROFILE_THREAD_NAME(name) profile_thread_name(name)
+#define PROFILE_BEGIN(name) profile_zone_begin(name)
+#define PROFILE_END() profile_zone_end()
+#define PROFILE_ZONE(name)                                                     \
+  int PROFILE_CONCAT(profile_scope_, __LINE__)                                 \
+      __attribute__((cleanup(profile_scope_end), unused)) =                    \
+          (profile_zone_begin(name), 0)
+#define PROFILE_FUNCTION() PROFILE_ZONE(__func__)
+#define PROFILE_DUMP(path) profile_write_chrome_trace(path)
+
+#else
+
+#define PROFILE_INIT() ((void)0)
+#define PROFILE_SHUTDOWN() ((void)0)
+#define PROFILE_THREAD_NAME(name) ((void)0)
+#define PROFILE_BEGIN(name) ((void)0)
+#define PROFILE_END() ((void)0)
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_DUMP(path) ((void)0)
+
+#endif // PROFILER_ENABLED
@@ -0,0 +1,156 @@
+#include "buffer_ring.h"
+#include "gl_state.h"
+
+#define BUFFER_RING_MAP_FLAGS                                                  \
+  (GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT)
+
+// The ring only binds GL_COPY_WRITE_BUFFER, which no VAO or draw looks at
+static int buffer_ring_storage(BufferRing *ring, size_t size,
+                               bool persistent) {
+  GLCall(glGenBuffers(1, &ring->buffer));
+  GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, ring->buffer));
+  if (persistent) {
+    GLCall(glBufferStorage(GL_COPY_WRITE_BUFFER, size, NULL,
+                           BUFFER_RING_MAP_FLAGS));
+    GLCall(void *data = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size,
+                                         BUFFER_RING_MAP_FLAGS));
+    ring->mapped = (unsigned char *)data;
+    if (!ring->mapped)
+      return 0;
+  } else {
+    GLCall(glBufferData(GL_COPY_WRITE_BUFFER, size, NULL, GL_STREAM_DRAW));
+  }
+  ring->size = size;
+  ring->regionSize = size / BUFFER_RING_FRAMES;
+  ring->region = 0;
+  ring->head = 0;
+  return 1;
+}
+
+// Deleting is safe with draws in flight, GL keeps the storage until they end
+static void buffer_ring_release(BufferRing *ring) {
+  if (ring->mapped) {
+    GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, ring->buffer));
+    GLCall(glUnmapBuffer(GL_COPY_WRITE_BUFFER));
+    ring->mapped = NULL;
+  }
+  for (int i = 0; i < BUFFER_RING_FRAMES; ++i) {
+    if (ring->fences[i]) {
+      GLCall(glDeleteSync(ring->fences[i]));
+      ring->fences[i] = NULL;
+    }
+  }
+  if (ring->buffer) {
+    GLCall(glDeleteBuffers(1, &ring->buffer));
+    ring->buffer = 0;
+    gl_state_invalidate();
+  }
+}
+
+int buffer_ring_create(BufferRing *ring, size_t size, bool persistent) {
+  memset(ring, 0, sizeof(*ring));
+  persistent = persistent && (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage);
+  size = (size + BUFFER_RING_FRAMES - 1) / BUFFER_RING_FRAMES *
+         BUFFER_RING_FRAMES;
+  if (!buffer_ring_storage(ring, size, persistent)) {
+    fprintf(stderr, "Could not map the buffer ring, orphaning instead\n");
+    buffer_ring_release(ring);
+    return buffer_ring_storage(ring, size, false);
+  }
+  return 1;
+}
+
+void buffer_ring_destroy(BufferRing *ring) {
+  buffer_ring_release(ring);
+  memset(ring, 0, sizeof(*ring));
+}
+
+// Blocks only when the GPU is still BUFFER_RING_FRAMES frames behind
+static void buffer_ring_wait(BufferRing *ring) {
+  GLsync fence = ring->fences[ring->region];
+  if (!fence)
+    return;
+  GLCall(GLenum status = glClientWaitSync(fence, 0, 0));
+  if (status == GL_TIMEOUT_EXPIRED) {
+    ring->waits++;
+    do {
+      GLCall(status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                       1000000000));
+    } while (status == GL_TIMEOUT_EXPIRED);
+  }
+  GLCall(glDeleteSync(fence));
+  ring->fences[ring->region] = NULL;
+}
+
+BufferRange buffer_ring_alloc(BufferRing *ring, size_t size,
+                              size_t alignment) {
+  size_t offset = (ring->head + alignment - 1) & ~(alignment - 1);
+
+  if (ring->mapped) {
+    buffer_ring_wait(ring);
+    size_t begin = ring->region * ring->regionSize;
+    if (offset + size > begin + ring->regionSize) {
+      size_t used = offset + size - begin;
+      size_t regionSize = ring->regionSize * 2;
+      while (regionSize < used)
+        regionSize *= 2;
+      buffer_ring_release(ring);
+      // Like buffer_ring_create, a failed map leaves an immutable buffer
+      // that orphaning can't use, so start over without storage
+      if (!buffer_ring_storage(ring, regionSize * BUFFER_RING_FRAMES, true)) {
+        fprintf(stderr, "Could not map the grown buffer ring, orphaning "
+                        "instead\n");
+        buffer_ring_release(ring);
+        if (!buffer_ring_storage(ring, regionSize * BUFFER_RING_FRAMES, false))
+          return (BufferRange){0};
+      }
+      ring->grows++;
+      offset = 0;
+    }
+    if (ring->mapped) {
+      ring->head = offset + size;
+      return (BufferRange){ring->buffer, offset, ring->mapped + offset};
+    }
+  }
+
+  GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, ring->buffer));
+  if (offset + size > ring->size) {
+    size_t capacity = ring->size;
+    while (capacity < size)
+      capacity *= 2;
+    GLCall(glBufferData(GL_COPY_WRITE_BUFFER, capacity, NULL, GL_STREAM_DRAW));
+    if (capacity > ring->size)
+      ring->grows++;
+    else
+      ring->orphans++;
+    ring->size = capacity;
+    offset = 0;
+  }
+  // Written ranges are never touched again before the orphan, no sync needed
+  GLCall(void *data = glMapBufferRange(
+             GL_COPY_WRITE_BUFFER, offset, size,
+             GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+                 GL_MAP_UNSYNCHRONIZED_BIT));
+  ring->head = offset + size;
+  return (BufferRange){ring->buffer, offset, data};
+}
+
+// Coherent mappings need nothing, the others have to be unmapped to draw
+void buffer_ring_commit(BufferRing *ring, const BufferRange *range) {
+  if (ring->mapped || !range->data)
+    return;
+  GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, range->buffer));
+  GLCall(glUnmapBuffer(GL_COPY_WRITE_BUFFER));
+}
+
+void buffer_ring_end_frame(BufferRing *ring) {
+  if (!ring->mapped)
+    return;
+  if (ring->fences[ring->region]) {
+    GLCall(glDeleteSync(ring->fences[ring->region]));
+  }
+  GLCall(ring->fences[ring->region] =
+             glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+  ring->region = (ring->region + 1) % BUFFER_RING_FRAMES;
+  ring->head = ring->region * ring->regionSize;
+}
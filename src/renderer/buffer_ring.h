@@ -0,0 +1,57 @@
+#pragma once
+#include "../utils/utils.h"
+#include <stdbool.h>
+
+// Streaming memory for dynamic geometry, shared by every renderer.
+//
+// One buffer is split into BUFFER_RING_FRAMES regions and each frame writes
+// into the next one. With GL_ARB_buffer_storage the buffer is mapped once,
+// persistently and coherently, so an allocation is a pointer bump and the
+// caller writes vertices straight into GPU-visible memory. The frame's region
+// is fenced when it ends and only waited on when the ring comes back around
+// to it, which with a few frames in flight is never.
+//
+// Without buffer storage every allocation maps its range unsynchronized and
+// the buffer is orphaned when it fills up instead.
+//
+// A frame that outgrows its region reallocates the ring at twice the size.
+// That replaces the buffer, so draw from a range before allocating the next.
+
+#ifndef BUFFER_RING_FRAMES
+#define BUFFER_RING_FRAMES 3
+#endif
+
+#ifndef BUFFER_RING_SIZE
+#define BUFFER_RING_SIZE (3 << 20) // bytes, all frames
+#endif
+
+typedef struct {
+  GLuint buffer;
+  size_t offset; // bytes, for glVertexAttribPointer
+  void *data;    // NULL when the allocation failed
+} BufferRange;
+
+typedef struct {
+  GLuint buffer;
+  unsigned char *mapped; // persistent mapping, NULL when orphaning
+  size_t size;           // bytes
+  size_t regionSize;     // bytes per frame, persistent only
+  size_t region;         // written this frame
+  size_t head;           // write cursor, bytes from the buffer start
+  GLsync fences[BUFFER_RING_FRAMES];
+
+  size_t waits;   // frames that found their region still in use
+  size_t grows;   // reallocations
+  size_t orphans; // times the orphaning buffer was full
+} BufferRing;
+
+// `persistent` asks for buffer storage, it's used only when supported
+int buffer_ring_create(BufferRing *ring, size_t size, bool persistent);
+void buffer_ring_destroy(BufferRing *ring);
+// `alignment` is a power of two
+BufferRange buffer_ring_alloc(BufferRing *ring, size_t size,
+                              size_t alignment);
+// Call once the range is written and before drawing from it
+void buffer_ring_commit(BufferRing *ring, const BufferRange *range);
+// After the last draw of the frame
+void buffer_ring_end_frame(BufferRing *ring);
@@ -0,0 +1,261 @@
+#include "capture.h"
+#include "../profiler/profiler.h"
+#include "gl_state.h"
+
+static bool capture_is_y4m(const char *path) {
+  size_t length = strlen(path);
+  return length >= 4 && strcmp(path + length - 4, ".y4m") == 0;
+}
+
+static inline unsigned char capture_clamp(int value) {
+  return value > 255 ? 255 : (unsigned char)value;
+}
+
+// Integer BT.601 full range. Chroma averages each 2x2 block; rows are
+// flipped since GL's origin is bottom-left.
+static int capture_write_y4m(FILE *file, const unsigned char *rgba, int width,
+                             int height) {
+  int chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+  Scratch scratch = scratch_begin(NULL);
+  unsigned char *y = (unsigned char *)arena_alloc(scratch.arena,
+                                                  (size_t)width * height);
+  unsigned char *u = (unsigned char *)arena_alloc(
+      scratch.arena, (size_t)chromaWidth * chromaHeight);
+  unsigned char *v = (unsigned char *)arena_alloc(
+      scratch.arena, (size_t)chromaWidth * chromaHeight);
+
+  for (int row = 0; row < height; ++row) {
+    const unsigned char *src = rgba + (size_t)(height - 1 - row) * width * 4;
+    unsigned char *dst = y + (size_t)row * width;
+    for (int x = 0; x < width; ++x) {
+      const unsigned char *p = src + x * 4;
+      dst[x] = (unsigned char)((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+    }
+  }
+
+  for (int cy = 0; cy < chromaHeight; ++cy) {
+    for (int cx = 0; cx < chromaWidth; ++cx) {
+      int r = 0, g = 0, b = 0, n = 0;
+      for (int row = 2 * cy; row < 2 * cy + 2 && row < height; ++row) {
+        const unsigned char *src =
+            rgba + (size_t)(height - 1 - row) * width * 4;
+        for (int x = 2 * cx; x < 2 * cx + 2 && x < width; ++x) {
+          r += src[x * 4 + 0];
+          g += src[x * 4 + 1];
+          b += src[x * 4 + 2];
+          n++;
+        }
+      }
+      // Offset by 128 so the numerators stay positive, then round
+      int bias = 128 * 256 * n + 128 * n;
+      size_t i = (size_t)cy * chromaWidth + cx;
+      u[i] = capture_clamp((-43 * r - 85 * g + 128 * b + bias) / (256 * n));
+      v[i] = capture_clamp((128 * r - 107 * g - 21 * b + bias) / (256 * n));
+    }
+  }
+
+  fputs("FRAME\n", file);
+  fwrite(y, 1, (size_t)width * height, file);
+  fwrite(u, 1, (size_t)chromaWidth * chromaHeight, file);
+  fwrite(v, 1, (size_t)chromaWidth * chromaHeight, file);
+  scratch_end(scratch);
+  return !ferror(file);
+}
+
+static void *capture_writer_main(void *arg) {
+  Capture *capture = (Capture *)arg;
+  PROFILE_THREAD_NAME("capture");
+  for (;;) {
+    pthread_mutex_lock(&capture->lock);
+    while (!capture->quit && capture->count == 0)
+      pthread_cond_wait(&capture->filled, &capture->lock);
+    if (capture->count == 0) {
+      pthread_mutex_unlock(&capture->lock);
+      break;
+    }
+    const unsigned char *pixels = capture->buffers[capture->head];
+    unsigned long frame = capture->frames[capture->head];
+    pthread_mutex_unlock(&capture->lock);
+
+    PROFILE_BEGIN("capture_write");
+    char path[4096];
+    int ok;
+    if (capture->y4m) {
+      snprintf(path, sizeof(path), "%s", capture->path);
+      ok = capture_write_y4m(capture->file, pixels, capture->width,
+                             capture->height);
+    } else {
+      snprintf(path, sizeof(path), capture->path, (int)frame);
+      ok = write_ppm(path, pixels, capture->width, capture->height);
+    }
+    if (!ok) {
+      fprintf(stderr, "Failed to write frame %lu to `%s`\n", frame, path);
+    }
+    PROFILE_END();
+
+    pthread_mutex_lock(&capture->lock);
+    capture->head = (capture->head + 1) % CAPTURE_QUEUE;
+    capture->count--;
+    capture->written++;
+    pthread_cond_signal(&capture->drained);
+    pthread_mutex_unlock(&capture->lock);
+  }
+  scratch_free();
+  return NULL;
+}
+
+int capture_open(Capture *capture, const char *path, int width, int height,
+                 int fps) {
+  memset(capture, 0, sizeof(*capture));
+  capture->path = path;
+  capture->y4m = capture_is_y4m(path);
+  capture->width = width;
+  capture->height = height;
+  capture->frameSize = (size_t)width * height * 4;
+
+  // The pattern is a printf format, it gets the frame index and nothing else
+  if (!capture->y4m && !frame_pattern_valid(path)) {
+    fprintf(stderr, "Capture path `%s` needs .y4m or exactly one %%d\n",
+            path);
+    capture->path = NULL;
+    return 0;
+  }
+
+  if (capture->y4m) {
+    capture->file = fopen(path, "wb");
+    if (!capture->file) {
+      fprintf(stderr, "Could not open `%s`\n", path);
+      capture->path = NULL;
+      return 0;
+    }
+    fprintf(capture->file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width,
+            height, fps);
+  }
+
+  for (int i = 0; i < CAPTURE_SLOTS; ++i) {
+    GLCall(glGenBuffers(1, &capture->slots[i].buffer));
+    gl_state_bind_buffer(GL_PIXEL_PACK_BUFFER, capture->slots[i].buffer);
+    GLCall(glBufferData(GL_PIXEL_PACK_BUFFER, capture->frameSize, NULL,
+                        GL_STREAM_READ));
+  }
+  // Left bound, every other glReadPixels would land in it
+  gl_state_bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  for (int i = 0; i < CAPTURE_QUEUE; ++i) {
+    capture->buffers[i] = (unsigned char *)malloc(capture->frameSize);
+  }
+  pthread_mutex_init(&capture->lock, NULL);
+  pthread_cond_init(&capture->filled, NULL);
+  pthread_cond_init(&capture->drained, NULL);
+  if (pthread_create(&capture->writer, NULL, capture_writer_main, capture) !=
+      0) {
+    fprintf(stderr, "Could not start the capture writer\n");
+    capture->quit = true;
+    capture_close(capture);
+    capture->path = NULL;
+    return 0;
+  }
+  return 1;
+}
+
+// Hands the slot's pixels to the writer, waiting for the GPU or for queue
+// space only when there is no other way
+static void capture_retire(Capture *capture, CaptureSlot *slot) {
+  if (!slot->fence)
+    return;
+  GLCall(GLenum status = glClientWaitSync(slot->fence, 0, 0));
+  if (status == GL_TIMEOUT_EXPIRED) {
+    PROFILE_ZONE("capture_gpu_wait");
+    capture->gpuWaits++;
+    do {
+      GLCall(status = glClientWaitSync(slot->fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                       1000000000));
+    } while (status == GL_TIMEOUT_EXPIRED);
+  }
+  GLCall(glDeleteSync(slot->fence));
+  slot->fence = NULL;
+
+  pthread_mutex_lock(&capture->lock);
+  if (capture->count == CAPTURE_QUEUE) {
+    PROFILE_ZONE("capture_disk_wait");
+    capture->diskWaits++;
+    while (capture->count == CAPTURE_QUEUE)
+      pthread_cond_wait(&capture->drained, &capture->lock);
+  }
+  size_t index = (capture->head + capture->count) % CAPTURE_QUEUE;
+  pthread_mutex_unlock(&capture->lock);
+
+  // Only this thread fills buffers past `count`, the writer won't touch it
+  gl_state_bind_buffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+  GLCall(void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                                         capture->frameSize,
+                                         GL_MAP_READ_BIT));
+  if (pixels) {
+    memcpy(capture->buffers[index], pixels, capture->frameSize);
+    GLCall(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+  }
+  gl_state_bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+  if (!pixels)
+    return;
+
+  pthread_mutex_lock(&capture->lock);
+  capture->frames[index] = slot->frame;
+  capture->count++;
+  pthread_cond_signal(&capture->filled);
+  pthread_mutex_unlock(&capture->lock);
+}
+
+void capture_frame(Capture *capture, unsigned long frame, int width,
+                   int height) {
+  PROFILE_FUNCTION();
+  if (width != capture->width || height != capture->height) {
+    capture->skipped++;
+    return;
+  }
+
+  // The slot being reused is the oldest one, frames stay in order
+  CaptureSlot *slot = &capture->slots[capture->nextSlot];
+  capture_retire(capture, slot);
+
+  gl_state_bind_buffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+  GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+  GLCall(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, NULL));
+  gl_state_bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+  GLCall(slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+  slot->frame = frame;
+  capture->nextSlot = (capture->nextSlot + 1) % CAPTURE_SLOTS;
+  capture->captured++;
+}
+
+void capture_close(Capture *capture) {
+  for (int i = 0; i < CAPTURE_SLOTS; ++i) {
+    capture_retire(capture,
+                   &capture->slots[(capture->nextSlot + i) % CAPTURE_SLOTS]);
+  }
+
+  pthread_mutex_lock(&capture->lock);
+  bool started = !capture->quit;
+  capture->quit = true;
+  pthread_cond_broadcast(&capture->filled);
+  pthread_mutex_unlock(&capture->lock);
+  if (started)
+    pthread_join(capture->writer, NULL);
+  pthread_mutex_destroy(&capture->lock);
+  pthread_cond_destroy(&capture->filled);
+  pthread_cond_destroy(&capture->drained);
+
+  for (int i = 0; i < CAPTURE_SLOTS; ++i) {
+    if (capture->slots[i].buffer) {
+      GLCall(glDeleteBuffers(1, &capture->slots[i].buffer));
+      capture->slots[i].buffer = 0;
+    }
+  }
+  for (int i = 0; i < CAPTURE_QUEUE; ++i) {
+    free(capture->buffers[i]);
+    capture->buffers[i] = NULL;
+  }
+  if (capture->file) {
+    fclose(capture->file);
+    capture->file = NULL;
+  }
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "../utils/utils.h"
+#include <pthread.h>
+#include <stdbool.h>
+
+// Frame capture that never waits on the GPU in the common case.
+//
+// capture_frame starts a glReadPixels into the next of CAPTURE_SLOTS pixel
+// pack buffers and fences it. A slot is mapped only once it comes around
+// again, CAPTURE_SLOTS frames later, by which time its fence has normally
+// passed. The pixels are copied into one of CAPTURE_QUEUE writer buffers and
+// a background thread encodes and writes them, so disk speed shows up in the
+// frame time only once the queue is full.
+//
+// Paths ending in .y4m get one YUV 4:2:0 stream (full range BT.601, what
+// ffmpeg calls yuvj420p); anything else is a printf pattern taking the frame
+// index and gets one PPM per frame through write_ppm.
+
+#ifndef CAPTURE_SLOTS
+#define CAPTURE_SLOTS 3
+#endif
+
+#ifndef CAPTURE_QUEUE
+#define CAPTURE_QUEUE 8
+#endif
+
+typedef struct {
+  GLuint buffer;
+  GLsync fence;
+  unsigned long frame;
+} CaptureSlot;
+
+typedef struct {
+  const char *path; // NULL when not capturing
+  bool y4m;
+  FILE *file; // y4m only
+  int width, height;
+  size_t frameSize; // bytes of RGBA
+
+  CaptureSlot slots[CAPTURE_SLOTS];
+  size_t nextSlot;
+
+  // Writer queue: `count` filled buffers from `head` on
+  pthread_t writer;
+  pthread_mutex_t lock;
+  pthread_cond_t filled;
+  pthread_cond_t drained;
+  unsigned char *buffers[CAPTURE_QUEUE];
+  unsigned long frames[CAPTURE_QUEUE];
+  size_t head, count;
+  bool quit;
+
+  size_t captured;  // frames read back
+  size_t written;   // by the writer, failures included
+  size_t skipped;   // size didn't match the capture
+  size_t gpuWaits;  // slots whose fence hadn't passed yet
+  size_t diskWaits; // frames that found the writer queue full
+} Capture;
+
+// Frames are width x height from the bound read framebuffer. `fps` only goes
+// into the y4m header. Fails on a pattern without exactly one %d.
+int capture_open(Capture *capture, const char *path, int width, int height,
+                 int fps);
+// Call after the frame is drawn, before swapping
+void capture_frame(Capture *capture, unsigned long frame, int width,
+                   int height);
+// Drains the slots and the writer
+void capture_close(Capture *capture);
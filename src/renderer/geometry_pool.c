@@ -0,0 +1,232 @@
+#include "geometry_pool.h"
+#include "../profiler/profiler.h"
+#include "gl_state.h"
+#include "shader.h"
+
+// Rotates and scales the mesh around its origin, then moves it into place
+#define GEOMETRY_VERTEX_PLACE                                                  \
+  "  float c = cos(transform.w), s = sin(transform.w);\n"                      \
+  "  vec2 p = transform.xy + transform.z * (mat2(c, s, -s, c) * position);\n"  \
+  "  tint = color.abgr * drawColor;\n"                                         \
+  "  vec2 ndc = p / screenSize * 2.0 - 1.0;\n"                                 \
+  "  gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);\n"
+
+static const char *geometry_indirect_vertex_source =
+    "#version 430 core\n"
+    "#extension GL_ARB_shader_draw_parameters : require\n"
+    "layout(location = 0) in vec2 position;\n"
+    "layout(location = 1) in vec4 color;\n"
+    "struct Draw {\n"
+    "  vec4 transform;\n"
+    "  vec4 color;\n"
+    "};\n"
+    "layout(std430, binding = 0) readonly buffer Draws { Draw draws[]; };\n"
+    "uniform vec2 screenSize;\n"
+    "out vec4 tint;\n"
+    "void main() {\n"
+    "  vec4 transform = draws[gl_DrawIDARB].transform;\n"
+    "  vec4 drawColor = draws[gl_DrawIDARB].color;\n" GEOMETRY_VERTEX_PLACE
+    "}\n";
+
+static const char *geometry_direct_vertex_source =
+    "#version 330 core\n"
+    "layout(location = 0) in vec2 position;\n"
+    "layout(location = 1) in vec4 color;\n"
+    "uniform vec4 transform;\n"
+    "uniform vec4 drawColor;\n"
+    "uniform vec2 screenSize;\n"
+    "out vec4 tint;\n"
+    "void main() {\n" GEOMETRY_VERTEX_PLACE "}\n";
+
+static const char *geometry_fragment_source =
+    "#version 330 core\n"
+    "in vec4 tint;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "  fragColor = tint;\n"
+    "}\n";
+
+int geometry_pool_create(GeometryPool *pool, BufferRing *ring,
+                         size_t maxVertices, size_t maxIndices,
+                         bool indirect) {
+  memset(pool, 0, sizeof(*pool));
+  pool->ring = ring;
+
+  pool->indirect = indirect && GLEW_VERSION_4_3 &&
+                   GLEW_ARB_shader_draw_parameters;
+  if (pool->indirect) {
+    pool->program = shader_program_create(geometry_indirect_vertex_source,
+                                          geometry_fragment_source);
+    if (!pool->program) {
+      fprintf(stderr, "Falling back to one draw call per object\n");
+      pool->indirect = false;
+    }
+  }
+  if (pool->indirect) {
+    GLint alignment = 0;
+    GLCall(glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT,
+                         &alignment));
+    pool->storageAlignment = alignment > 16 ? (size_t)alignment : 16;
+  } else {
+    pool->program = shader_program_create(geometry_direct_vertex_source,
+                                          geometry_fragment_source);
+    if (!pool->program)
+      return 0;
+    GLCall(pool->transformLocation =
+               glGetUniformLocation(pool->program, "transform"));
+    GLCall(pool->colorLocation =
+               glGetUniformLocation(pool->program, "drawColor"));
+  }
+  GLCall(pool->screenSizeLocation =
+             glGetUniformLocation(pool->program, "screenSize"));
+
+  pool->vertexCapacity = maxVertices;
+  pool->indexCapacity = maxIndices;
+  GLCall(glGenVertexArrays(1, &pool->vao));
+  GLCall(glGenBuffers(1, &pool->vertexBuffer));
+  GLCall(glGenBuffers(1, &pool->indexBuffer));
+  gl_state_bind_vertex_array(pool->vao);
+  gl_state_bind_buffer(GL_ARRAY_BUFFER, pool->vertexBuffer);
+  GLCall(glBufferData(GL_ARRAY_BUFFER, maxVertices * sizeof(GeometryVertex),
+                      NULL, GL_STATIC_DRAW));
+  gl_state_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, pool->indexBuffer);
+  GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, maxIndices * sizeof(uint32_t),
+                      NULL, GL_STATIC_DRAW));
+  GLCall(glEnableVertexAttribArray(0));
+  GLCall(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE,
+                               sizeof(GeometryVertex),
+                               (void *)offsetof(GeometryVertex, x)));
+  GLCall(glEnableVertexAttribArray(1));
+  GLCall(glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+                               sizeof(GeometryVertex),
+                               (void *)offsetof(GeometryVertex, color)));
+
+  return 1;
+}
+
+void geometry_pool_destroy(GeometryPool *pool) {
+  GLCall(glDeleteProgram(pool->program));
+  GLCall(glDeleteVertexArrays(1, &pool->vao));
+  GLCall(glDeleteBuffers(1, &pool->vertexBuffer));
+  GLCall(glDeleteBuffers(1, &pool->indexBuffer));
+  gl_state_invalidate();
+  free(pool->meshes);
+  free(pool->drawMeshes);
+  free(pool->draws);
+  memset(pool, 0, sizeof(*pool));
+}
+
+int geometry_pool_add_mesh(GeometryPool *pool, const GeometryVertex *vertices,
+                           size_t vertexCount, const uint32_t *indices,
+                           size_t indexCount) {
+  if (pool->vertexCount + vertexCount > pool->vertexCapacity ||
+      pool->indexCount + indexCount > pool->indexCapacity) {
+    fprintf(stderr, "Geometry pool is full\n");
+    return -1;
+  }
+  if (pool->meshCount >= pool->meshCapacity) {
+    pool->meshCapacity = pool->meshCapacity == 0 ? 16 : pool->meshCapacity * 2;
+    pool->meshes = (GeometryMesh *)realloc(
+        pool->meshes, pool->meshCapacity * sizeof(GeometryMesh));
+  }
+
+  // The element buffer binding belongs to the VAO
+  gl_state_bind_vertex_array(pool->vao);
+  gl_state_bind_buffer(GL_ARRAY_BUFFER, pool->vertexBuffer);
+  GLCall(glBufferSubData(GL_ARRAY_BUFFER,
+                         pool->vertexCount * sizeof(GeometryVertex),
+                         vertexCount * sizeof(GeometryVertex), vertices));
+  GLCall(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER,
+                         pool->indexCount * sizeof(uint32_t),
+                         indexCount * sizeof(uint32_t), indices));
+
+  pool->meshes[pool->meshCount] = (GeometryMesh){
+      .firstIndex = (uint32_t)pool->indexCount,
+      .indexCount = (uint32_t)indexCount,
+      .baseVertex = (int32_t)pool->vertexCount,
+  };
+  pool->vertexCount += vertexCount;
+  pool->indexCount += indexCount;
+  return (int)pool->meshCount++;
+}
+
+void geometry_pool_begin(GeometryPool *pool) { pool->drawCount = 0; }
+
+void geometry_pool_draw(GeometryPool *pool, int mesh,
+                        const GeometryDraw *draw) {
+  if (pool->drawCount >= pool->drawCapacity) {
+    size_t capacity = pool->drawCapacity == 0 ? 1024 : pool->drawCapacity * 2;
+    pool->drawMeshes = (uint32_t *)realloc(pool->drawMeshes,
+                                           capacity * sizeof(uint32_t));
+    pool->draws =
+        (GeometryDraw *)realloc(pool->draws, capacity * sizeof(GeometryDraw));
+    pool->drawCapacity = capacity;
+  }
+  pool->drawMeshes[pool->drawCount] = (uint32_t)mesh;
+  pool->draws[pool->drawCount] = *draw;
+  pool->drawCount++;
+}
+
+// Commands and per-draw records share one ring allocation
+static void geometry_pool_flush_indirect(GeometryPool *pool) {
+  size_t commandSize = pool->drawCount * sizeof(GeometryCommand);
+  size_t drawOffset = (commandSize + pool->storageAlignment - 1) &
+                      ~(pool->storageAlignment - 1);
+  size_t drawSize = pool->drawCount * sizeof(GeometryDraw);
+  BufferRange range = buffer_ring_alloc(pool->ring, drawOffset + drawSize,
+                                        pool->storageAlignment);
+  if (!range.data)
+    return;
+
+  GeometryCommand *commands = (GeometryCommand *)range.data;
+  for (size_t i = 0; i < pool->drawCount; ++i) {
+    const GeometryMesh *mesh = &pool->meshes[pool->drawMeshes[i]];
+    commands[i] = (GeometryCommand){
+        .count = mesh->indexCount,
+        .instanceCount = 1,
+        .firstIndex = mesh->firstIndex,
+        .baseVertex = mesh->baseVertex,
+    };
+  }
+  memcpy((unsigned char *)range.data + drawOffset, pool->draws, drawSize);
+  buffer_ring_commit(pool->ring, &range);
+
+  gl_state_bind_buffer(GL_DRAW_INDIRECT_BUFFER, range.buffer);
+  GLCall(glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, range.buffer,
+                           range.offset + drawOffset, drawSize));
+  GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                     (void *)range.offset,
+                                     (GLsizei)pool->drawCount, 0));
+}
+
+static void geometry_pool_flush_direct(GeometryPool *pool) {
+  for (size_t i = 0; i < pool->drawCount; ++i) {
+    const GeometryMesh *mesh = &pool->meshes[pool->drawMeshes[i]];
+    const GeometryDraw *d = &pool->draws[i];
+    GLCall(glUniform4f(pool->transformLocation, d->x, d->y, d->scale,
+                       d->rotation));
+    GLCall(glUniform4f(pool->colorLocation, d->r, d->g, d->b, d->a));
+    GLCall(glDrawElementsBaseVertex(
+        GL_TRIANGLES, (GLsizei)mesh->indexCount, GL_UNSIGNED_INT,
+        (void *)(mesh->firstIndex * sizeof(uint32_t)), mesh->baseVertex));
+  }
+}
+
+void geometry_pool_flush(GeometryPool *pool, int screenWidth,
+                         int screenHeight) {
+  PROFILE_FUNCTION();
+  if (pool->drawCount == 0)
+    return;
+
+  gl_state_enable(GL_BLEND);
+  gl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  gl_state_use_program(pool->program);
+  GLCall(glUniform2f(pool->screenSizeLocation, (float)screenWidth,
+                     (float)screenHeight));
+  gl_state_bind_vertex_array(pool->vao);
+  if (pool->indirect) {
+    geometry_pool_flush_indirect(pool);
+  } else {
+    geometry_pool_flush_direct(pool);
+  }
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "../utils/utils.h"
+#include "buffer_ring.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Static meshes packed into one shared vertex and index buffer, drawn any
+// number of times per frame with a single glMultiDrawElementsIndirect.
+//
+// Meshes are appended once and never move. Each frame the draws are turned
+// into indirect commands plus a per-draw record (transform and tint) written
+// into the buffer ring; the vertex shader picks its record with gl_DrawID.
+//
+// Without GL 4.3 and GL_ARB_shader_draw_parameters, or with `indirect` off,
+// every draw becomes a uniform update and a glDrawElementsBaseVertex.
+
+typedef struct {
+  float x, y;     // pixels, around the mesh origin
+  uint32_t color; // 0xRRGGBBAA
+} GeometryVertex;
+
+typedef struct {
+  uint32_t firstIndex;
+  uint32_t indexCount;
+  int32_t baseVertex;
+} GeometryMesh;
+
+// std430 layout of a per-draw record
+typedef struct {
+  float x, y, scale, rotation;
+  float r, g, b, a; // multiplies the vertex color
+} GeometryDraw;
+
+typedef struct {
+  uint32_t count;
+  uint32_t instanceCount;
+  uint32_t firstIndex;
+  int32_t baseVertex;
+  uint32_t baseInstance;
+} GeometryCommand;
+
+typedef struct {
+  bool indirect;
+  GLuint program;
+  GLint screenSizeLocation;
+  GLint transformLocation; // per-draw uniforms, direct draws only
+  GLint colorLocation;
+  GLuint vao;
+  GLuint vertexBuffer;
+  GLuint indexBuffer;
+  size_t vertexCapacity, vertexCount;
+  size_t indexCapacity, indexCount;
+  size_t storageAlignment; // GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+  BufferRing *ring;
+
+  GeometryMesh *meshes;
+  size_t meshCount, meshCapacity;
+
+  // This frame's draws
+  uint32_t *drawMeshes;
+  GeometryDraw *draws;
+  size_t drawCount, drawCapacity;
+} GeometryPool;
+
+// Room for `maxVertices` and `maxIndices` across all meshes. `indirect` asks
+// for multi-draw-indirect, it's used only when supported.
+int geometry_pool_create(GeometryPool *pool, BufferRing *ring,
+                         size_t maxVertices, size_t maxIndices,
+                         bool indirect);
+void geometry_pool_destroy(GeometryPool *pool);
+// Returns the mesh id, or -1 when the pool is full
+int geometry_pool_add_mesh(GeometryPool *pool, const GeometryVertex *vertices,
+                           size_t vertexCount, const uint32_t *indices,
+                           size_t indexCount);
+
+void geometry_pool_begin(GeometryPool *pool);
+void geometry_pool_draw(GeometryPool *pool, int mesh,
+                        const GeometryDraw *draw);
+void geometry_pool_flush(GeometryPool *pool, int screenWidth,
+                         int screenHeight);
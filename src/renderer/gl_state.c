@@ -0,0 +1,277 @@
+#include "gl_state.h"
+
+static void gl_real_use_program(GLuint program) {
+  GLCall(glUseProgram(program));
+}
+static void gl_real_bind_vertex_array(GLuint vao) {
+  GLCall(glBindVertexArray(vao));
+}
+static void gl_real_bind_buffer(GLenum target, GLuint buffer) {
+  GLCall(glBindBuffer(target, buffer));
+}
+static void gl_real_bind_framebuffer(GLenum target, GLuint framebuffer) {
+  GLCall(glBindFramebuffer(target, framebuffer));
+}
+static void gl_real_active_texture(GLenum unit) {
+  GLCall(glActiveTexture(unit));
+}
+static void gl_real_bind_texture(GLenum target, GLuint texture) {
+  GLCall(glBindTexture(target, texture));
+}
+static void gl_real_enable(GLenum cap) { GLCall(glEnable(cap)); }
+static void gl_real_disable(GLenum cap) { GLCall(glDisable(cap)); }
+static void gl_real_blend_func(GLenum src, GLenum dst) {
+  GLCall(glBlendFunc(src, dst));
+}
+static void gl_real_color_mask(GLboolean r, GLboolean g, GLboolean b,
+                               GLboolean a) {
+  GLCall(glColorMask(r, g, b, a));
+}
+static void gl_real_stencil_mask(GLuint mask) { GLCall(glStencilMask(mask)); }
+static void gl_real_viewport(GLint x, GLint y, GLsizei width,
+                             GLsizei height) {
+  GLCall(glViewport(x, y, width, height));
+}
+
+static const GlBackend gl_backend_real = {
+    .useProgram = gl_real_use_program,
+    .bindVertexArray = gl_real_bind_vertex_array,
+    .bindBuffer = gl_real_bind_buffer,
+    .bindFramebuffer = gl_real_bind_framebuffer,
+    .activeTexture = gl_real_active_texture,
+    .bindTexture = gl_real_bind_texture,
+    .enable = gl_real_enable,
+    .disable = gl_real_disable,
+    .blendFunc = gl_real_blend_func,
+    .colorMask = gl_real_color_mask,
+    .stencilMask = gl_real_stencil_mask,
+    .viewport = gl_real_viewport,
+};
+
+// Bits of gl_state.known
+enum {
+  GL_STATE_PROGRAM = 1 << 0,
+  GL_STATE_VAO = 1 << 1,
+  GL_STATE_ARRAY_BUFFER = 1 << 2,
+  GL_STATE_DRAW_FRAMEBUFFER = 1 << 3,
+  GL_STATE_READ_FRAMEBUFFER = 1 << 4,
+  GL_STATE_ACTIVE_TEXTURE = 1 << 5,
+  GL_STATE_BLEND_FUNC = 1 << 6,
+  GL_STATE_COLOR_MASK = 1 << 7,
+  GL_STATE_STENCIL_MASK = 1 << 8,
+  GL_STATE_VIEWPORT = 1 << 9,
+};
+
+static const GLenum gl_state_caps[] = {
+    GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_SCISSOR_TEST, GL_STENCIL_TEST,
+};
+
+static struct {
+  const GlBackend *backend;
+  unsigned known;
+  GLuint program;
+  GLuint vao;
+  GLuint arrayBuffer;
+  GLuint drawFramebuffer;
+  GLuint readFramebuffer;
+  GLuint activeTexture; // unit index
+  GLuint textures[GL_STATE_TEXTURE_UNITS];
+  unsigned texturesKnown; // bit per unit
+  unsigned capsKnown;     // bit per gl_state_caps entry
+  unsigned capsEnabled;
+  GLenum blendSrc, blendDst;
+  GLboolean colorMask[4];
+  GLuint stencilMask;
+  GLint viewport[4];
+
+  GlStateCounters frame;
+  GlStateCounters lastFrame;
+  GlStateCounters total;
+} gl_state = {.backend = &gl_backend_real};
+
+// Counts the call and says whether it has to go through
+static bool gl_state_issue(bool known, bool same) {
+  if (known && same) {
+    gl_state.frame.filtered++;
+    return false;
+  }
+  gl_state.frame.issued++;
+  return true;
+}
+
+static bool gl_state_update(unsigned field, bool same) {
+  if (!gl_state_issue(gl_state.known & field, same))
+    return false;
+  gl_state.known |= field;
+  return true;
+}
+
+void gl_state_init(const GlBackend *backend) {
+  gl_state.backend = backend ? backend : &gl_backend_real;
+  gl_state.frame = gl_state.lastFrame = gl_state.total = (GlStateCounters){0};
+  gl_state_invalidate();
+}
+
+void gl_state_invalidate(void) {
+  gl_state.known = 0;
+  gl_state.texturesKnown = 0;
+  gl_state.capsKnown = 0;
+}
+
+void gl_state_end_frame(void) {
+  gl_state.lastFrame = gl_state.frame;
+  gl_state.total.issued += gl_state.frame.issued;
+  gl_state.total.filtered += gl_state.frame.filtered;
+  gl_state.frame = (GlStateCounters){0};
+}
+
+GlStateCounters gl_state_last_frame(void) { return gl_state.lastFrame; }
+
+GlStateCounters gl_state_total(void) {
+  return (GlStateCounters){
+      gl_state.total.issued + gl_state.frame.issued,
+      gl_state.total.filtered + gl_state.frame.filtered,
+  };
+}
+
+void gl_state_use_program(GLuint program) {
+  if (gl_state_update(GL_STATE_PROGRAM, gl_state.program == program)) {
+    gl_state.program = program;
+    gl_state.backend->useProgram(program);
+  }
+}
+
+void gl_state_bind_vertex_array(GLuint vao) {
+  if (gl_state_update(GL_STATE_VAO, gl_state.vao == vao)) {
+    gl_state.vao = vao;
+    gl_state.backend->bindVertexArray(vao);
+  }
+}
+
+void gl_state_bind_buffer(GLenum target, GLuint buffer) {
+  if (target != GL_ARRAY_BUFFER) {
+    gl_state_issue(false, false);
+    gl_state.backend->bindBuffer(target, buffer);
+    return;
+  }
+  if (gl_state_update(GL_STATE_ARRAY_BUFFER, gl_state.arrayBuffer == buffer)) {
+    gl_state.arrayBuffer = buffer;
+    gl_state.backend->bindBuffer(target, buffer);
+  }
+}
+
+void gl_state_bind_framebuffer(GLenum target, GLuint framebuffer) {
+  unsigned fields = 0;
+  bool same = true;
+  if (target != GL_READ_FRAMEBUFFER) {
+    fields |= GL_STATE_DRAW_FRAMEBUFFER;
+    same = same && gl_state.drawFramebuffer == framebuffer;
+  }
+  if (target != GL_DRAW_FRAMEBUFFER) {
+    fields |= GL_STATE_READ_FRAMEBUFFER;
+    same = same && gl_state.readFramebuffer == framebuffer;
+  }
+  if (!gl_state_issue((gl_state.known & fields) == fields, same))
+    return;
+  gl_state.known |= fields;
+  if (fields & GL_STATE_DRAW_FRAMEBUFFER)
+    gl_state.drawFramebuffer = framebuffer;
+  if (fields & GL_STATE_READ_FRAMEBUFFER)
+    gl_state.readFramebuffer = framebuffer;
+  gl_state.backend->bindFramebuffer(target, framebuffer);
+}
+
+// Not counted, it only happens on the way to a bind that is
+static void gl_state_active_texture(GLuint unit) {
+  if ((gl_state.known & GL_STATE_ACTIVE_TEXTURE) &&
+      gl_state.activeTexture == unit)
+    return;
+  gl_state.known |= GL_STATE_ACTIVE_TEXTURE;
+  gl_state.activeTexture = unit;
+  gl_state.backend->activeTexture(GL_TEXTURE0 + unit);
+}
+
+void gl_state_bind_texture(GLuint unit, GLenum target, GLuint texture) {
+  if (target != GL_TEXTURE_2D || unit >= GL_STATE_TEXTURE_UNITS) {
+    gl_state_issue(false, false);
+    gl_state_active_texture(unit);
+    gl_state.backend->bindTexture(target, texture);
+    return;
+  }
+  unsigned bit = 1u << unit;
+  if (!gl_state_issue(gl_state.texturesKnown & bit,
+                      gl_state.textures[unit] == texture))
+    return;
+  gl_state.texturesKnown |= bit;
+  gl_state.textures[unit] = texture;
+  gl_state_active_texture(unit);
+  gl_state.backend->bindTexture(target, texture);
+}
+
+static int gl_state_cap_index(GLenum cap) {
+  for (size_t i = 0; i < sizeof(gl_state_caps) / sizeof(gl_state_caps[0]);
+       ++i) {
+    if (gl_state_caps[i] == cap)
+      return (int)i;
+  }
+  return -1;
+}
+
+static bool gl_state_set_cap(GLenum cap, bool enabled) {
+  int i = gl_state_cap_index(cap);
+  if (i < 0)
+    return gl_state_issue(false, false);
+  unsigned bit = 1u << i;
+  if (!gl_state_issue(gl_state.capsKnown & bit,
+                      ((gl_state.capsEnabled & bit) != 0) == enabled))
+    return false;
+  gl_state.capsKnown |= bit;
+  gl_state.capsEnabled =
+      enabled ? gl_state.capsEnabled | bit : gl_state.capsEnabled & ~bit;
+  return true;
+}
+
+void gl_state_enable(GLenum cap) {
+  if (gl_state_set_cap(cap, true))
+    gl_state.backend->enable(cap);
+}
+
+void gl_state_disable(GLenum cap) {
+  if (gl_state_set_cap(cap, false))
+    gl_state.backend->disable(cap);
+}
+
+void gl_state_blend_func(GLenum src, GLenum dst) {
+  if (gl_state_update(GL_STATE_BLEND_FUNC,
+                      gl_state.blendSrc == src && gl_state.blendDst == dst)) {
+    gl_state.blendSrc = src;
+    gl_state.blendDst = dst;
+    gl_state.backend->blendFunc(src, dst);
+  }
+}
+
+void gl_state_color_mask(GLboolean r, GLboolean g, GLboolean b, GLboolean a) {
+  GLboolean *mask = gl_state.colorMask;
+  if (gl_state_update(GL_STATE_COLOR_MASK, mask[0] == r && mask[1] == g &&
+                                               mask[2] == b && mask[3] == a)) {
+    mask[0] = r, mask[1] = g, mask[2] = b, mask[3] = a;
+    gl_state.backend->colorMask(r, g, b, a);
+  }
+}
+
+void gl_state_stencil_mask(GLuint mask) {
+  if (gl_state_update(GL_STATE_STENCIL_MASK, gl_state.stencilMask == mask)) {
+    gl_state.stencilMask = mask;
+    gl_state.backend->stencilMask(mask);
+  }
+}
+
+void gl_state_viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+  GLint *v = gl_state.viewport;
+  if (gl_state_update(GL_STATE_VIEWPORT, v[0] == x && v[1] == y &&
+                                             v[2] == width &&
+                                             v[3] == height)) {
+    v[0] = x, v[1] = y, v[2] = width, v[3] = height;
+    gl_state.backend->viewport(x, y, width, height);
+  }
+}
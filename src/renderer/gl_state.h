@@ -0,0 +1,62 @@
+#pragma once
+#include "../utils/utils.h"
+#include <stdbool.h>
+
+// Mirror of the GL bindings and render state the renderers touch, so a call
+// that wouldn't change anything never reaches the driver.
+//
+// Everything that binds or toggles tracked state has to come through here,
+// or call gl_state_invalidate() afterwards; so does deleting a bound object,
+// since GL hands the name out again. State starts out unknown, the first call
+// for each piece always goes through.
+//
+// The calls that do go through are made on a GlBackend. The default one is
+// the real GL; a recording backend lets the filtering be checked without a
+// context.
+
+// Texture units whose GL_TEXTURE_2D binding is tracked
+#define GL_STATE_TEXTURE_UNITS 16
+
+typedef struct {
+  void (*useProgram)(GLuint program);
+  void (*bindVertexArray)(GLuint vao);
+  void (*bindBuffer)(GLenum target, GLuint buffer);
+  void (*bindFramebuffer)(GLenum target, GLuint framebuffer);
+  void (*activeTexture)(GLenum unit);
+  void (*bindTexture)(GLenum target, GLuint texture);
+  void (*enable)(GLenum cap);
+  void (*disable)(GLenum cap);
+  void (*blendFunc)(GLenum src, GLenum dst);
+  void (*colorMask)(GLboolean r, GLboolean g, GLboolean b, GLboolean a);
+  void (*stencilMask)(GLuint mask);
+  void (*viewport)(GLint x, GLint y, GLsizei width, GLsizei height);
+} GlBackend;
+
+typedef struct {
+  size_t issued;
+  size_t filtered;
+} GlStateCounters;
+
+// NULL for the real GL. Forgets all state, call it with a new context.
+void gl_state_init(const GlBackend *backend);
+void gl_state_invalidate(void);
+// Closes the frame's counters
+void gl_state_end_frame(void);
+GlStateCounters gl_state_last_frame(void);
+GlStateCounters gl_state_total(void);
+
+void gl_state_use_program(GLuint program);
+void gl_state_bind_vertex_array(GLuint vao);
+// Only GL_ARRAY_BUFFER is tracked, element buffers belong to the VAO
+void gl_state_bind_buffer(GLenum target, GLuint buffer);
+// GL_FRAMEBUFFER, GL_DRAW_FRAMEBUFFER or GL_READ_FRAMEBUFFER
+void gl_state_bind_framebuffer(GLenum target, GLuint framebuffer);
+// `unit` counts from 0; only GL_TEXTURE_2D is tracked
+void gl_state_bind_texture(GLuint unit, GLenum target, GLuint texture);
+// Blend, cull face, depth, scissor and stencil test are tracked
+void gl_state_enable(GLenum cap);
+void gl_state_disable(GLenum cap);
+void gl_state_blend_func(GLenum src, GLenum dst);
+void gl_state_color_mask(GLboolean r, GLboolean g, GLboolean b, GLboolean a);
+void gl_state_stencil_mask(GLuint mask);
+void gl_state_viewport(GLint x, GLint y, GLsizei width, GLsizei height);
@@ -0,0 +1,143 @@
+#include "path_renderer.h"
+#include "gl_state.h"
+#include "shader.h"
+
+static const char *path_vertex_source =
+    "#version 330 core\n"
+    "layout(location = 0) in vec2 position;\n"
+    "layout(location = 1) in vec2 curve;\n"
+    "uniform vec2 screenSize;\n"
+    "out vec2 uv;\n"
+    "void main() {\n"
+    "  uv = curve;\n"
+    "  vec2 ndc = position / screenSize * 2.0 - 1.0;\n"
+    "  gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);\n"
+    "}\n";
+
+// Fan and cover vertices sit at uv (0, 1), which is always inside
+static const char *path_fragment_source =
+    "#version 330 core\n"
+    "in vec2 uv;\n"
+    "uniform vec4 color;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "  if (uv.x * uv.x - uv.y > 0.0) discard;\n"
+    "  fragColor = color;\n"
+    "}\n";
+
+int path_renderer_create(PathRenderer *pr, BufferRing *ring) {
+  memset(pr, 0, sizeof(*pr));
+  pr->ring = ring;
+
+  pr->program = shader_program_create(path_vertex_source, path_fragment_source);
+  if (!pr->program)
+    return 0;
+  GLCall(pr->screenSizeLocation =
+             glGetUniformLocation(pr->program, "screenSize"));
+  GLCall(pr->colorLocation = glGetUniformLocation(pr->program, "color"));
+
+  GLCall(glGenVertexArrays(1, &pr->vao));
+  gl_state_bind_vertex_array(pr->vao);
+  GLCall(glEnableVertexAttribArray(0));
+  GLCall(glEnableVertexAttribArray(1));
+
+  return 1;
+}
+
+void path_renderer_destroy(PathRenderer *pr) {
+  GLCall(glDeleteProgram(pr->program));
+  GLCall(glDeleteVertexArrays(1, &pr->vao));
+  gl_state_invalidate();
+  memset(pr, 0, sizeof(*pr));
+}
+
+static inline void path_vertex(PathVertex **out, float x, float y, float u,
+                               float v) {
+  **out = (PathVertex){x, y, u, v};
+  (*out)++;
+}
+
+void path_renderer_fill(PathRenderer *pr, const PathSegment *segments,
+                        size_t count, uint32_t color, int screenWidth,
+                        int screenHeight) {
+  if (count == 0)
+    return;
+
+  // One fan triangle per segment, a curve triangle per quad, the cover quad
+  size_t maxVertices = 6 * count + 6;
+  BufferRange range = buffer_ring_alloc(
+      pr->ring, maxVertices * sizeof(PathVertex), sizeof(PathVertex));
+  if (!range.data)
+    return;
+
+  PathVertex *begin = (PathVertex *)range.data;
+  PathVertex *out = begin;
+  float ax = segments[0].x1, ay = segments[0].y1;
+  float minX = ax, minY = ay, maxX = ax, maxY = ay;
+  for (size_t i = 0; i < count; ++i) {
+    const PathSegment *s = &segments[i];
+    float ex = s->kind == PATH_QUAD ? s->x3 : s->x2;
+    float ey = s->kind == PATH_QUAD ? s->y3 : s->y2;
+    path_vertex(&out, ax, ay, 0, 1);
+    path_vertex(&out, s->x1, s->y1, 0, 1);
+    path_vertex(&out, ex, ey, 0, 1);
+    if (s->kind == PATH_QUAD) {
+      path_vertex(&out, s->x1, s->y1, 0, 0);
+      path_vertex(&out, s->x2, s->y2, 0.5f, 0);
+      path_vertex(&out, s->x3, s->y3, 1, 1);
+    }
+
+    // The control point bounds the curve
+    float xs[3] = {s->x1, s->x2, s->x3};
+    float ys[3] = {s->y1, s->y2, s->y3};
+    for (int j = 0; j < (s->kind == PATH_QUAD ? 3 : 2); ++j) {
+      minX = xs[j] < minX ? xs[j] : minX;
+      maxX = xs[j] > maxX ? xs[j] : maxX;
+      minY = ys[j] < minY ? ys[j] : minY;
+      maxY = ys[j] > maxY ? ys[j] : maxY;
+    }
+  }
+  GLsizei stencilVertices = (GLsizei)(out - begin);
+  path_vertex(&out, minX, minY, 0, 1);
+  path_vertex(&out, maxX, minY, 0, 1);
+  path_vertex(&out, minX, maxY, 0, 1);
+  path_vertex(&out, maxX, minY, 0, 1);
+  path_vertex(&out, maxX, maxY, 0, 1);
+  path_vertex(&out, minX, maxY, 0, 1);
+  buffer_ring_commit(pr->ring, &range);
+
+  gl_state_use_program(pr->program);
+  GLCall(glUniform2f(pr->screenSizeLocation, (float)screenWidth,
+                     (float)screenHeight));
+  GLCall(glUniform4f(pr->colorLocation, ((color >> 24) & 0xFF) / 255.0f,
+                     ((color >> 16) & 0xFF) / 255.0f,
+                     ((color >> 8) & 0xFF) / 255.0f, (color & 0xFF) / 255.0f));
+  gl_state_bind_vertex_array(pr->vao);
+  gl_state_bind_buffer(GL_ARRAY_BUFFER, range.buffer);
+  GLCall(glVertexAttribPointer(
+      0, 2, GL_FLOAT, GL_FALSE, sizeof(PathVertex),
+      (void *)(range.offset + offsetof(PathVertex, x))));
+  GLCall(glVertexAttribPointer(
+      1, 2, GL_FLOAT, GL_FALSE, sizeof(PathVertex),
+      (void *)(range.offset + offsetof(PathVertex, u))));
+
+  // Stencil: front faces add one, back faces take one away
+  gl_state_enable(GL_STENCIL_TEST);
+  gl_state_disable(GL_CULL_FACE);
+  gl_state_color_mask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  gl_state_stencil_mask(0xFF);
+  GLCall(glStencilFunc(GL_ALWAYS, 0, 0xFF));
+  GLCall(glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_INCR_WRAP));
+  GLCall(glStencilOpSeparate(GL_BACK, GL_KEEP, GL_KEEP, GL_DECR_WRAP));
+  GLCall(glDrawArrays(GL_TRIANGLES, 0, stencilVertices));
+
+  // Cover: nonzero winding is inside, zeroing leaves the stencil clean
+  gl_state_color_mask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  gl_state_enable(GL_BLEND);
+  gl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  GLCall(glStencilFunc(GL_NOTEQUAL, 0, 0xFF));
+  GLCall(glStencilOp(GL_ZERO, GL_ZERO, GL_ZERO));
+  GLCall(glDrawArrays(GL_TRIANGLES, stencilVertices, 6));
+
+  gl_state_disable(GL_STENCIL_TEST);
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "../utils/utils.h"
+#include "buffer_ring.h"
+#include <stdint.h>
+
+// Filled vector paths drawn with stencil-then-cover, no CPU rasterization.
+//
+// The stencil pass draws a fan triangle from the first point to every
+// segment's chord, plus a curve triangle per quadratic that discards
+// fragments outside the curve (Loop-Blinn), counting nonzero winding with
+// increment/decrement wrap. The cover pass draws the bounding quad where the
+// stencil is nonzero and clears it again behind itself.
+//
+// Vertices are written straight into the shared buffer ring, so any path
+// costs two draw calls and no upload of its own. Contours must be closed;
+// several contours can share one draw.
+
+typedef enum {
+  PATH_LINE,
+  PATH_QUAD,
+} PathSegmentKind;
+
+// Lines go from p1 to p2, quadratics from p1 to p3 with p2 as control point
+typedef struct {
+  PathSegmentKind kind;
+  float x1, y1, x2, y2, x3, y3;
+} PathSegment;
+
+typedef struct {
+  float x, y;
+  float u, v;
+} PathVertex;
+
+typedef struct {
+  GLuint program;
+  GLint screenSizeLocation;
+  GLint colorLocation;
+  GLuint vao;
+  BufferRing *ring;
+} PathRenderer;
+
+// `ring` has to outlive the renderer
+int path_renderer_create(PathRenderer *pr, BufferRing *ring);
+void path_renderer_destroy(PathRenderer *pr);
+// Pixels, y down like the text renderer. Needs a stencil buffer.
+void path_renderer_fill(PathRenderer *pr, const PathSegment *segments,
+                        size_t count, uint32_t color, int screenWidth,
+                        int screenHeight);
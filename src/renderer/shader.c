@@ -0,0 +1,253 @@
+#include "shader.h"
+#include <errno.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define SHADER_CACHE_MAGIC 0x48534752u // "RGSH"
+
+typedef struct {
+  uint32_t magic;
+  uint32_t format;
+  uint64_t key;
+  uint64_t length;
+} ShaderCacheHeader;
+
+static const char *shader_cache_directory = NULL;
+static uint64_t shader_cache_driver_hash = 0;
+static ShaderCacheStats shader_cache_counters = {0};
+
+static double shader_time(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// FNV-1a
+static uint64_t shader_hash(uint64_t hash, const char *str) {
+  if (!str)
+    return hash;
+  for (; *str; ++str) {
+    hash ^= (unsigned char)*str;
+    hash *= 0x100000001b3ull;
+  }
+  return hash ^ 0xff; // separator so "ab"+"c" != "a"+"bc"
+}
+
+void shader_cache_init(const char *directory) {
+  shader_cache_directory = NULL;
+  shader_cache_counters = (ShaderCacheStats){0};
+  if (!directory)
+    return;
+
+  // Program binaries are core only from 4.1, the context asks for 3.3
+  if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary) {
+    fprintf(stderr, "No GL_ARB_get_program_binary, shader cache disabled\n");
+    return;
+  }
+  GLint formats = 0;
+  GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats));
+  if (formats == 0) {
+    fprintf(stderr, "Driver supports no program binary formats, shader cache "
+                    "disabled\n");
+    return;
+  }
+  if (mkdir(directory, 0755) != 0 && errno != EEXIST) {
+    fprintf(stderr, "Could not create shader cache `%s`\n", directory);
+    return;
+  }
+
+  uint64_t hash = 0xcbf29ce484222325ull;
+  GLCall(hash = shader_hash(hash, (const char *)glGetString(GL_VENDOR)));
+  GLCall(hash = shader_hash(hash, (const char *)glGetString(GL_RENDERER)));
+  GLCall(hash = shader_hash(hash, (const char *)glGetString(GL_VERSION)));
+  shader_cache_driver_hash = hash;
+  shader_cache_directory = directory;
+}
+
+ShaderCacheStats shader_cache_stats(void) { return shader_cache_counters; }
+
+static void shader_cache_path(char *path, size_t size, uint64_t key) {
+  snprintf(path, size, "%s/%016llx.bin", shader_cache_directory,
+           (unsigned long long)key);
+}
+
+static GLuint shader_cache_load(uint64_t key) {
+  char path[4096];
+  shader_cache_path(path, sizeof(path), key);
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return 0;
+
+  Scratch scratch = scratch_begin(NULL);
+  ShaderCacheHeader header;
+  void *binary = NULL;
+  GLuint program = 0;
+  struct stat st;
+  if (fread(&header, sizeof(header), 1, f) != 1 ||
+      header.magic != SHADER_CACHE_MAGIC || header.key != key)
+    goto done;
+  // A truncated or damaged file is just a miss, don't trust its length
+  if (fstat(fileno(f), &st) != 0 || header.length == 0 ||
+      header.length != (uint64_t)st.st_size - sizeof(header))
+    goto done;
+  binary = arena_alloc(scratch.arena, header.length);
+  if (fread(binary, 1, header.length, f) != header.length)
+    goto done;
+
+  // A stale or foreign binary is allowed to fail, so no GLCall here
+  GLCall(program = glCreateProgram());
+  glProgramBinary(program, header.format, binary, (GLsizei)header.length);
+  gl_clear_error();
+  GLint status = 0;
+  GLCall(glGetProgramiv(program, GL_LINK_STATUS, &status));
+  if (!status) {
+    GLCall(glDeleteProgram(program));
+    program = 0;
+    shader_cache_counters.rejected++;
+  }
+
+done:
+  scratch_end(scratch);
+  fclose(f);
+  return program;
+}
+
+static void shader_cache_store(uint64_t key, GLuint program) {
+  GLint length = 0;
+  GLCall(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+  if (length <= 0)
+    return;
+
+  Scratch scratch = scratch_begin(NULL);
+  void *binary = arena_alloc(scratch.arena, length);
+  GLenum format = 0;
+  GLCall(glGetProgramBinary(program, length, NULL, &format, binary));
+
+  char path[4096], tmpPath[4096 + 8];
+  shader_cache_path(path, sizeof(path), key);
+  snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+  FILE *f = fopen(tmpPath, "wb");
+  if (f) {
+    ShaderCacheHeader header = {SHADER_CACHE_MAGIC, format, key,
+                                (uint64_t)length};
+    int ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+             fwrite(binary, 1, length, f) == (size_t)length;
+    ok = fclose(f) == 0 && ok;
+    if (ok)
+      rename(tmpPath, path);
+    else
+      remove(tmpPath);
+  }
+  scratch_end(scratch);
+}
+
+GLuint shader_compile(GLenum type, const char *source) {
+  GLCall(GLuint shader = glCreateShader(type));
+  GLCall(glShaderSource(shader, 1, &source, NULL));
+  GLCall(glCompileShader(shader));
+
+  GLint status = 0;
+  GLCall(glGetShaderiv(shader, GL_COMPILE_STATUS, &status));
+  if (!status) {
+    char log[1024];
+    GLCall(glGetShaderInfoLog(shader, sizeof(log), NULL, log));
+    fprintf(stderr, "Failed to compile %s shader:\n%s\n",
+            type == GL_VERTEX_SHADER ? "vertex" : "fragment", log);
+    GLCall(glDeleteShader(shader));
+    return 0;
+  }
+  return shader;
+}
+
+static GLuint shader_program_link(const char *vertexSource,
+                                  const char *fragmentSource) {
+  GLuint vs = shader_compile(GL_VERTEX_SHADER, vertexSource);
+  if (!vs)
+    return 0;
+  GLuint fs = shader_compile(GL_FRAGMENT_SHADER, fragmentSource);
+  if (!fs) {
+    GLCall(glDeleteShader(vs));
+    return 0;
+  }
+
+  GLCall(GLuint program = glCreateProgram());
+  if (shader_cache_directory) {
+    GLCall(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                               GL_TRUE));
+  }
+  GLCall(glAttachShader(program, vs));
+  GLCall(glAttachShader(program, fs));
+  GLCall(glLinkProgram(program));
+  GLCall(glDeleteShader(vs));
+  GLCall(glDeleteShader(fs));
+
+  GLint status = 0;
+  GLCall(glGetProgramiv(program, GL_LINK_STATUS, &status));
+  if (!status) {
+    char log[1024];
+    GLCall(glGetProgramInfoLog(program, sizeof(log), NULL, log));
+    fprintf(stderr, "Failed to link program:\n%s\n", log);
+    GLCall(glDeleteProgram(program));
+    return 0;
+  }
+  return program;
+}
+
+GLuint shader_program_create(const char *vertexSource,
+                             const char *fragmentSource) {
+  double start = shader_time();
+  GLuint program = 0;
+
+  uint64_t key = 0;
+  if (shader_cache_directory) {
+    key = shader_hash(shader_cache_driver_hash, vertexSource);
+    key = shader_hash(key, fragmentSource);
+    program = shader_cache_load(key);
+  }
+
+  if (program) {
+    shader_cache_counters.hits++;
+  } else {
+    program = shader_program_link(vertexSource, fragmentSource);
+    if (program && shader_cache_directory) {
+      shader_cache_counters.misses++;
+      shader_cache_store(key, program);
+    }
+  }
+
+  shader_cache_counters.seconds += shader_time() - start;
+  return program;
+}
+
+char *shader_read_file(Arena *arena, const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    fprintf(stderr, "Could not open shader `%s`\n", path);
+    return NULL;
+  }
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+
+  char *source = (char *)arena_alloc(arena, size + 1);
+  if (fread(source, 1, size, f) != (size_t)size) {
+    fprintf(stderr, "Could not read shader `%s`\n", path);
+    fclose(f);
+    return NULL;
+  }
+  source[size] = '\0';
+  fclose(f);
+  return source;
+}
+
+GLuint shader_program_load(const char *vertexPath, const char *fragmentPath) {
+  Scratch scratch = scratch_begin(NULL);
+  char *vertexSource = shader_read_file(scratch.arena, vertexPath);
+  char *fragmentSource = shader_read_file(scratch.arena, fragmentPath);
+  GLuint program = 0;
+  if (vertexSource && fragmentSource)
+    program = shader_program_create(vertexSource, fragmentSource);
+  scratch_end(scratch);
+  return program;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "../utils/utils.h"
+
+// Errors are printed to stderr, failures return 0 (NULL for the file).
+GLuint shader_compile(GLenum type, const char *source);
+GLuint shader_program_create(const char *vertexSource,
+                             const char *fragmentSource);
+GLuint shader_program_load(const char *vertexPath, const char *fragmentPath);
+char *shader_read_file(Arena *arena, const char *path);
+
+// Linked programs are cached on disk through glGetProgramBinary, keyed by a
+// hash of the sources and of GL_VENDOR/GL_RENDERER/GL_VERSION, so a source
+// edit or a driver update simply misses. Binaries the driver rejects are
+// recompiled and overwritten, files that don't hold what their header says
+// are ignored the same way. Disabled until shader_cache_init is called, or
+// without GL 4.1 / GL_ARB_get_program_binary or any binary format. The stats
+// count from the last shader_cache_init.
+typedef struct {
+  int hits;
+  int misses;
+  int rejected;
+  double seconds; // total time spent creating programs
+} ShaderCacheStats;
+
+void shader_cache_init(const char *directory);
+ShaderCacheStats shader_cache_stats(void);
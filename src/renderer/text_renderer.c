@@ -0,0 +1,282 @@
+#include "text_renderer.h"
+#include "gl_state.h"
+#include "shader.h"
+
+static const char *text_vertex_source =
+    "#version 330 core\n"
+    "layout(location = 0) in vec4 rect;\n"
+    "layout(location = 1) in vec4 uvRect;\n"
+    "layout(location = 2) in vec4 color;\n"
+    "uniform vec2 screenSize;\n"
+    "out vec2 uv;\n"
+    "out vec4 tint;\n"
+    "void main() {\n"
+    "  vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);\n"
+    "  vec2 position = rect.xy + corner * rect.zw;\n"
+    "  uv = mix(uvRect.xy, uvRect.zw, corner);\n"
+    "  tint = color.abgr;\n"
+    "  vec2 ndc = position / screenSize * 2.0 - 1.0;\n"
+    "  gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *text_fragment_source =
+    "#version 330 core\n"
+    "in vec2 uv;\n"
+    "in vec4 tint;\n"
+    "uniform sampler2D atlas;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "  fragColor = vec4(tint.rgb, tint.a * texture(atlas, uv).r);\n"
+    "}\n";
+
+// Rasterizes the printable ASCII range into a single-channel atlas, packing
+// glyphs in rows. The first pass only measures the atlas height.
+static void text_font_pack_atlas(TextFont *font, FT_Face face,
+                                 unsigned char *pixels, int height,
+                                 int *usedHeight) {
+  int x = 0, y = 0, rowHeight = 0;
+  for (int c = TEXT_FIRST_CHAR; c <= TEXT_LAST_CHAR; ++c) {
+    Glyph *g = &font->glyphs[c - TEXT_FIRST_CHAR];
+    if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
+      fprintf(stderr, "Could not load glyph '%c'\n", c);
+      continue;
+    }
+    FT_Bitmap *bitmap = &face->glyph->bitmap;
+    if (x + (int)bitmap->width > TEXT_ATLAS_WIDTH) {
+      x = 0;
+      y += rowHeight + 1;
+      rowHeight = 0;
+    }
+
+    if (pixels) {
+      for (unsigned int row = 0; row < bitmap->rows; ++row) {
+        memcpy(pixels + (size_t)(y + row) * TEXT_ATLAS_WIDTH + x,
+               bitmap->buffer + row * bitmap->pitch, bitmap->width);
+      }
+      g->width = bitmap->width;
+      g->height = bitmap->rows;
+      g->bearingX = face->glyph->bitmap_left;
+      g->bearingY = face->glyph->bitmap_top;
+      g->advance = (int)(face->glyph->advance.x >> 6);
+      g->u0 = (float)x / TEXT_ATLAS_WIDTH;
+      g->v0 = (float)y / height;
+      g->u1 = (float)(x + bitmap->width) / TEXT_ATLAS_WIDTH;
+      g->v1 = (float)(y + bitmap->rows) / height;
+    }
+
+    x += bitmap->width + 1;
+    if ((int)bitmap->rows > rowHeight)
+      rowHeight = bitmap->rows;
+  }
+  *usedHeight = y + rowHeight;
+}
+
+// A FreeType library per call keeps concurrent decodes independent
+int text_font_decode(TextFont *font, Arena *arena, const unsigned char *data,
+                     size_t size, int pixelHeight) {
+  memset(font, 0, sizeof(*font));
+
+  FT_Library library;
+  if (FT_Init_FreeType(&library)) {
+    fprintf(stderr, "Error initializing FreeType library\n");
+    return 0;
+  }
+  FT_Face face;
+  if (FT_New_Memory_Face(library, data, (FT_Long)size, 0, &face)) {
+    fprintf(stderr, "ERROR: Could not load font\n");
+    FT_Done_FreeType(library);
+    return 0;
+  }
+  FT_Set_Pixel_Sizes(face, 0, pixelHeight);
+  font->lineHeight = (int)(face->size->metrics.height >> 6);
+  font->ascender = (int)(face->size->metrics.ascender >> 6);
+
+  int usedHeight = 0;
+  text_font_pack_atlas(font, face, NULL, 0, &usedHeight);
+  int height = 1;
+  while (height < usedHeight)
+    height *= 2;
+
+  size_t atlasSize = (size_t)TEXT_ATLAS_WIDTH * height;
+  font->pixels = (unsigned char *)arena_alloc_aligned(arena, atlasSize,
+                                                      ARENA_REGION_ALIGNMENT);
+  memset(font->pixels, 0, atlasSize);
+  text_font_pack_atlas(font, face, font->pixels, height, &usedHeight);
+  font->atlasHeight = height;
+
+  FT_Done_Face(face);
+  FT_Done_FreeType(library);
+  return 1;
+}
+
+void text_renderer_set_font(TextRenderer *tr, const TextFont *font) {
+  memcpy(tr->glyphs, font->glyphs, sizeof(tr->glyphs));
+  tr->lineHeight = font->lineHeight;
+  tr->ascender = font->ascender;
+  tr->atlasWidth = TEXT_ATLAS_WIDTH;
+  tr->atlasHeight = font->atlasHeight;
+
+  if (!tr->atlas) {
+    GLCall(glGenTextures(1, &tr->atlas));
+  }
+  gl_state_bind_texture(0, GL_TEXTURE_2D, tr->atlas);
+  GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+  GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, TEXT_ATLAS_WIDTH,
+                      font->atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE,
+                      font->pixels));
+  GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+  GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+  GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+  GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+}
+
+int text_renderer_init(TextRenderer *tr, const char *fontPath,
+                       int pixelHeight) {
+  if (!text_renderer_create(tr))
+    return 0;
+
+  Scratch scratch = scratch_begin(NULL);
+  size_t size = 0;
+  unsigned char *data = read_file(scratch.arena, fontPath, &size);
+  TextFont font;
+  int ok = data && text_font_decode(&font, scratch.arena, data, size,
+                                    pixelHeight);
+  if (ok) {
+    text_renderer_set_font(tr, &font);
+  } else {
+    fprintf(stderr, "ERROR: Could not load font `%s`\n", fontPath);
+  }
+  scratch_end(scratch);
+  return ok;
+}
+
+int text_renderer_create(TextRenderer *tr) {
+  memset(tr, 0, sizeof(*tr));
+
+  tr->program = shader_program_create(text_vertex_source, text_fragment_source);
+  if (!tr->program)
+    return 0;
+  GLCall(tr->screenSizeLocation =
+             glGetUniformLocation(tr->program, "screenSize"));
+
+  // Growing the buffer keeps its name, so the attributes are set up once
+  GLCall(glGenVertexArrays(1, &tr->vao));
+  GLCall(glGenBuffers(1, &tr->instanceVbo));
+  gl_state_bind_vertex_array(tr->vao);
+  gl_state_bind_buffer(GL_ARRAY_BUFFER, tr->instanceVbo);
+  GLCall(glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(TextInstance),
+                               (void *)offsetof(TextInstance, x)));
+  GLCall(glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(TextInstance),
+                               (void *)offsetof(TextInstance, u0)));
+  GLCall(glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+                               sizeof(TextInstance),
+                               (void *)offsetof(TextInstance, color)));
+  for (GLuint i = 0; i < 3; ++i) {
+    GLCall(glEnableVertexAttribArray(i));
+    GLCall(glVertexAttribDivisor(i, 1));
+  }
+
+  return 1;
+}
+
+void text_renderer_destroy(TextRenderer *tr) {
+  GLCall(glDeleteProgram(tr->program));
+  GLCall(glDeleteVertexArrays(1, &tr->vao));
+  GLCall(glDeleteBuffers(1, &tr->instanceVbo));
+  GLCall(glDeleteTextures(1, &tr->atlas));
+  gl_state_invalidate();
+  free(tr->instances);
+  tr->instances = NULL;
+}
+
+void text_renderer_begin(TextRenderer *tr) {
+  tr->count = 0;
+  tr->dirtyBegin = SIZE_MAX;
+  tr->dirtyEnd = 0;
+}
+
+static void text_renderer_push(TextRenderer *tr, const TextInstance *instance) {
+  if (tr->count >= tr->capacity) {
+    size_t capacity = tr->capacity == 0 ? 1024 : tr->capacity * 2;
+    tr->instances = (TextInstance *)realloc(tr->instances,
+                                            capacity * sizeof(TextInstance));
+    tr->capacity = capacity;
+
+    // Buffer storage is reallocated, everything has to go up again
+    gl_state_bind_buffer(GL_ARRAY_BUFFER, tr->instanceVbo);
+    GLCall(glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(TextInstance), NULL,
+                        GL_DYNAMIC_DRAW));
+    tr->lastCount = 0;
+    tr->dirtyBegin = 0;
+    tr->dirtyEnd = tr->count;
+  }
+
+  size_t i = tr->count++;
+  if (i < tr->lastCount &&
+      memcmp(&tr->instances[i], instance, sizeof(*instance)) == 0)
+    return;
+
+  tr->instances[i] = *instance;
+  if (i < tr->dirtyBegin)
+    tr->dirtyBegin = i;
+  if (i + 1 > tr->dirtyEnd)
+    tr->dirtyEnd = i + 1;
+}
+
+float text_renderer_draw_string(TextRenderer *tr, float x, float y,
+                                const char *text, uint32_t color) {
+  if (!tr->atlas)
+    return x; // font still loading
+  float penX = x;
+  float baseline = y + tr->ascender;
+  for (const char *c = text; *c; ++c) {
+    if (*c == '\n') {
+      penX = x;
+      baseline += tr->lineHeight;
+      continue;
+    }
+    if (*c < TEXT_FIRST_CHAR || *c > TEXT_LAST_CHAR)
+      continue;
+
+    Glyph *g = &tr->glyphs[*c - TEXT_FIRST_CHAR];
+    if (g->width > 0 && g->height > 0) {
+      TextInstance instance = {
+          .x = penX + g->bearingX,
+          .y = baseline - g->bearingY,
+          .width = (float)g->width,
+          .height = (float)g->height,
+          .u0 = g->u0,
+          .v0 = g->v0,
+          .u1 = g->u1,
+          .v1 = g->v1,
+          .color = color,
+      };
+      text_renderer_push(tr, &instance);
+    }
+    penX += g->advance;
+  }
+  return penX;
+}
+
+void text_renderer_flush(TextRenderer *tr, int screenWidth, int screenHeight) {
+  if (tr->dirtyBegin < tr->dirtyEnd) {
+    gl_state_bind_buffer(GL_ARRAY_BUFFER, tr->instanceVbo);
+    GLCall(glBufferSubData(
+        GL_ARRAY_BUFFER, tr->dirtyBegin * sizeof(TextInstance),
+        (tr->dirtyEnd - tr->dirtyBegin) * sizeof(TextInstance),
+        &tr->instances[tr->dirtyBegin]));
+  }
+  tr->lastCount = tr->count;
+
+  if (tr->count == 0)
+    return;
+
+  gl_state_bind_vertex_array(tr->vao);
+  gl_state_enable(GL_BLEND);
+  gl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  gl_state_use_program(tr->program);
+  GLCall(glUniform2f(tr->screenSizeLocation, (float)screenWidth,
+                     (float)screenHeight));
+  gl_state_bind_texture(0, GL_TEXTURE_2D, tr->atlas);
+  GLCall(glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)tr->count));
+}
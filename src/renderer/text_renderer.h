@@ -0,0 +1,78 @@
+#pragma once
+#include "../utils/utils.h"
+#include <stdint.h>
+
+#include FT_FREETYPE_H
+
+// Text drawn as instanced quads sampling a glyph atlas that is uploaded once.
+//
+// Each frame: text_renderer_begin, any number of text_renderer_draw_string,
+// then text_renderer_flush which issues a single instanced draw for all the
+// text. Instances stay in the renderer's own buffer rather than the shared
+// ring: text mostly repeats from frame to frame, so each instance is compared
+// with last frame's and only the changed range is uploaded.
+
+#define TEXT_FIRST_CHAR 32
+#define TEXT_LAST_CHAR 126
+#define TEXT_ATLAS_WIDTH 512
+
+typedef struct {
+  float x, y, width, height;
+  float u0, v0, u1, v1;
+  uint32_t color; // 0xRRGGBBAA
+} TextInstance;
+
+typedef struct {
+  float u0, v0, u1, v1;
+  int width, height;
+  int bearingX, bearingY;
+  int advance;
+} Glyph;
+
+// CPU half of a font: glyph metrics and atlas pixels. Decoding touches no GL
+// state, so it can run on any thread; text_renderer_set_font uploads it.
+typedef struct {
+  Glyph glyphs[TEXT_LAST_CHAR - TEXT_FIRST_CHAR + 1];
+  int lineHeight;
+  int ascender;
+  unsigned char *pixels; // TEXT_ATLAS_WIDTH x atlasHeight, R8
+  int atlasHeight;
+} TextFont;
+
+typedef struct {
+  GLuint program;
+  GLint screenSizeLocation;
+  GLuint vao;
+  GLuint instanceVbo;
+  GLuint atlas;
+  int atlasWidth, atlasHeight;
+
+  Glyph glyphs[TEXT_LAST_CHAR - TEXT_FIRST_CHAR + 1];
+  int lineHeight;
+  int ascender;
+
+  TextInstance *instances;
+  size_t count;      // instances written this frame
+  size_t lastCount;  // instances drawn last frame
+  size_t capacity;   // of both the CPU array and the GPU buffer
+  size_t dirtyBegin; // range of instances to upload on flush
+  size_t dirtyEnd;
+} TextRenderer;
+
+// Blocking: reads and decodes the font and creates the renderer
+int text_renderer_init(TextRenderer *tr, const char *fontPath,
+                       int pixelHeight);
+// GL objects only, nothing is drawn until a font is set
+int text_renderer_create(TextRenderer *tr);
+void text_renderer_set_font(TextRenderer *tr, const TextFont *font);
+// `data` is a font file in memory, pixels are allocated from `arena`
+int text_font_decode(TextFont *font, Arena *arena, const unsigned char *data,
+                     size_t size, int pixelHeight);
+void text_renderer_destroy(TextRenderer *tr);
+
+void text_renderer_begin(TextRenderer *tr);
+// (x, y) is the top-left corner of the first line, in pixels, y down.
+// Returns the pen x position after the last character.
+float text_renderer_draw_string(TextRenderer *tr, float x, float y,
+                                const char *text, uint32_t color);
+void text_renderer_flush(TextRenderer *tr, int screenWidth, int screenHeight);
@@ -0,0 +1,21 @@
+#define ARENA_IMPLEMENTATION
+#include "memory.h"
+
+static __thread Arena scratch_arenas[2];
+
+Scratch scratch_begin(Arena *conflict) {
+  Arena *arena = &scratch_arenas[0];
+  if (arena == conflict)
+    arena = &scratch_arenas[1];
+
+  Scratch scratch = {arena, arena_snapshot(arena)};
+  return scratch;
+}
+
+void scratch_end(Scratch scratch) { arena_rewind(scratch.arena, scratch.mark); }
+
+// Releases the calling thread's scratch memory, for threads about to exit.
+void scratch_free(void) {
+  arena_free(&scratch_arenas[0]);
+  arena_free(&scratch_arenas[1]);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+// Every translation unit has to agree on the backend, Arena_Region differs
+// between them. Include arena.h through this header only.
+#ifdef __linux__
+#define ARENA_BACKEND ARENA_BACKEND_LINUX_VMEM
+#endif
+#define ARENA_CONCURRENT
+#include "../../libs/arena.h"
+
+// Per-thread scratch arenas for temporaries that die with the calling scope:
+//
+//   Scratch scratch = scratch_begin(NULL);
+//   char *tmp = arena_alloc(scratch.arena, n);
+//   ...
+//   scratch_end(scratch);
+//
+// A function that allocates its results into an arena passed by the caller
+// should pass that arena as `conflict`, so its temporaries are not rewound on
+// top of the results when the caller itself is using scratch memory.
+typedef struct {
+  Arena *arena;
+  Arena_Mark mark;
+} Scratch;
+
+Scratch scratch_begin(Arena *conflict);
+void scratch_end(Scratch scratch);
+void scratch_free(void);
@@ -0,0 +1,98 @@
+#include "pool.h"
+#include <string.h>
+
+typedef struct {
+  uint32_t index;
+  uint32_t generation; // odd while live, even while free
+} Pool_Header;
+
+void pool_init(Pool *p, Arena *arena, size_t item_size, int flags) {
+  memset(p, 0, sizeof(*p));
+  p->arena = arena;
+  p->item_size = item_size;
+  p->header = (flags & POOL_HANDLES) ? sizeof(Pool_Header) : 0;
+
+  // Free slots hold the next pointer in the item area
+  size_t size = item_size < sizeof(void *) ? sizeof(void *) : item_size;
+  size = (size + sizeof(uintptr_t) - 1) / sizeof(uintptr_t) * sizeof(uintptr_t);
+  p->stride = p->header + size;
+  p->slab_items = POOL_SLAB_ITEMS;
+  p->next_unused = p->slab_items;
+}
+
+static Pool_Header *pool_header(const Pool *p, const void *item) {
+  return (Pool_Header *)((char *)item - p->header);
+}
+
+static void *pool_slot(const Pool *p, size_t index) {
+  char *slab = (char *)p->slabs.items[index / p->slab_items];
+  return slab + (index % p->slab_items) * p->stride + p->header;
+}
+
+static void pool_new_slab(Pool *p) {
+  void *slab = arena_alloc_aligned(p->arena, p->slab_items * p->stride,
+                                   POOL_CACHE_LINE);
+  arena_da_append(p->arena, &p->slabs, slab);
+  p->next_unused = 0;
+}
+
+void *pool_alloc(Pool *p) {
+  void *item = p->free_list;
+  if (item) {
+    p->free_list = *(void **)item;
+  } else {
+    if (p->next_unused == p->slab_items)
+      pool_new_slab(p);
+    size_t index = (p->slabs.count - 1) * p->slab_items + p->next_unused++;
+    item = pool_slot(p, index);
+    if (p->header) {
+      Pool_Header *h = pool_header(p, item);
+      h->index = (uint32_t)index;
+      h->generation = 0;
+    }
+  }
+
+  if (p->header)
+    pool_header(p, item)->generation++;
+  p->live++;
+  return item;
+}
+
+void pool_free(Pool *p, void *item) {
+  if (!item)
+    return;
+  if (p->header) {
+    Pool_Header *h = pool_header(p, item);
+    ARENA_ASSERT((h->generation & 1) && "double free");
+    h->generation++;
+  }
+  *(void **)item = p->free_list;
+  p->free_list = item;
+  p->live--;
+}
+
+size_t pool_capacity(const Pool *p) {
+  if (p->slabs.count == 0)
+    return 0;
+  return (p->slabs.count - 1) * p->slab_items + p->next_unused;
+}
+
+Pool_Handle pool_handle(const Pool *p, const void *item) {
+  Pool_Handle handle = {0};
+  if (item && p->header) {
+    Pool_Header *h = pool_header(p, item);
+    handle.index = h->index;
+    handle.generation = h->generation;
+  }
+  return handle;
+}
+
+void *pool_get(const Pool *p, Pool_Handle handle) {
+  if (!p->header || handle.generation == 0 ||
+      handle.index >= pool_capacity(p))
+    return NULL;
+  void *item = pool_slot(p, handle.index);
+  if (pool_header(p, item)->generation != handle.generation)
+    return NULL;
+  return item;
+}
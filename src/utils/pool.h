@@ -0,0 +1,58 @@
+#pragma once
+#include "memory.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Fixed-size object pool on top of an arena. Slots come in cache-line
+// aligned slabs carved from the arena and are recycled through an intrusive
+// free list, so pool_alloc and pool_free are O(1) and never touch malloc.
+// Memory goes back only with the arena (arena_reset/arena_free), after which
+// the pool must be re-initialized.
+//
+// With POOL_HANDLES every slot carries a generation that is bumped on free,
+// and Pool_Handle {index, generation} can be checked for staleness with
+// pool_get. Without it a slot is exactly the item size (rounded to a word).
+
+#define POOL_HANDLES 1
+
+#ifndef POOL_SLAB_ITEMS
+#define POOL_SLAB_ITEMS 1024
+#endif
+
+#define POOL_CACHE_LINE 64
+
+typedef struct {
+  uint32_t index;
+  uint32_t generation; // 0 is never a live generation
+} Pool_Handle;
+
+typedef struct {
+  void **items;
+  size_t count;
+  size_t capacity;
+} Pool_Slabs;
+
+typedef struct {
+  Arena *arena;
+  size_t item_size;
+  size_t stride; // bytes per slot, header included
+  size_t header; // bytes before the item, 0 without POOL_HANDLES
+  size_t slab_items;
+
+  Pool_Slabs slabs;
+  void *free_list;
+  size_t next_unused; // slots never handed out in the last slab
+  size_t live;
+} Pool;
+
+void pool_init(Pool *p, Arena *arena, size_t item_size, int flags);
+void *pool_alloc(Pool *p);
+void pool_free(Pool *p, void *item);
+size_t pool_capacity(const Pool *p);
+
+Pool_Handle pool_handle(const Pool *p, const void *item);
+void *pool_get(const Pool *p, Pool_Handle handle);
+
+#define pool_init_typed(p, arena, Type, flags)                                 \
+  pool_init((p), (arena), sizeof(Type), (flags))
+#define pool_alloc_typed(p, Type) ((Type *)pool_alloc(p))
@@ -19,3 +19,67 @@ void get_vertices16(float *vertices, unsigned int *indices, float width,
   };
   memcpy(indices, tempIndices, sizeof(tempIndices));
 }
+
+// Whole file into `arena`, NULL if it can't be read.
+unsigned char *read_file(Arena *arena, const char *path, size_t *size) {
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return NULL;
+  fseek(f, 0, SEEK_END);
+  long length = ftell(f);
+  fseek(f, 0, SEEK_SET);
+
+  unsigned char *data = NULL;
+  if (length >= 0) {
+    data = (unsigned char *)arena_alloc(arena, length);
+    if (fread(data, 1, length, f) != (size_t)length)
+      data = NULL;
+  }
+  fclose(f);
+  *size = data ? (size_t)length : 0;
+  return data;
+}
+
+bool frame_pattern_valid(const char *pattern) {
+  int conversions = 0;
+  for (const char *p = pattern; *p; ++p) {
+    if (*p != '%')
+      continue;
+    if (*++p == '%')
+      continue;
+    while (*p && strchr("-+ #0", *p))
+      p++;
+    while (*p >= '0' && *p <= '9')
+      p++;
+    if (*p != 'd' && *p != 'i' && *p != 'u')
+      return false;
+    conversions++;
+  }
+  return conversions == 1;
+}
+
+// Writes a bottom-up RGBA buffer (as returned by glReadPixels) as binary PPM.
+int write_ppm(const char *path, const unsigned char *rgba, int width,
+              int height) {
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return 0;
+
+  fprintf(f, "P6\n%d %d\n255\n", width, height);
+  Scratch scratch = scratch_begin(NULL);
+  unsigned char *row = (unsigned char *)arena_alloc(scratch.arena, width * 3);
+  for (int y = height - 1; y >= 0; --y) {
+    const unsigned char *src = rgba + (size_t)y * width * 4;
+    for (int x = 0; x < width; ++x) {
+      row[x * 3 + 0] = src[x * 4 + 0];
+      row[x * 3 + 1] = src[x * 4 + 1];
+      row[x * 3 + 2] = src[x * 4 + 2];
+    }
+    fwrite(row, 3, width, f);
+  }
+  scratch_end(scratch);
+
+  int ok = !ferror(f);
+  fclose(f);
+  return ok;
+}
@@ -2,10 +2,13 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <freetype2/ft2build.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "memory.h"
+
 #define ASSERT(x)                                                              \
   if (!(x))                                                                    \
     __builtin_trap();
@@ -22,3 +25,14 @@ int gl_log_call(const char *function, const char *file, int line);
 // Object Utils
 void get_vertices16(float *vertexArray, unsigned int *indices, float width,
                     float height, float texWidth, float texHeight);
+
+// File Utils
+unsigned char *read_file(Arena *arena, const char *path, size_t *size);
+// True for a printf pattern with exactly one int conversion (%d, %i or %u,
+// flags and width allowed), e.g. "frames/%04d.ppm". Frame indices are passed
+// to it as int.
+bool frame_pattern_valid(const char *pattern);
+
+// Image Utils
+int write_ppm(const char *path, const unsigned char *rgba, int width,
+              int height);
@@ -0,0 +1,56 @@
+#include "alloc_count.h"
+
+// The one file that calls the real functions
+#undef malloc
+#undef calloc
+#undef realloc
+#undef aligned_alloc
+#undef free
+#include <stdlib.h>
+
+static bool alloc_counting = false;
+static size_t alloc_calls = 0;
+
+static void alloc_count_call(void) {
+  if (__atomic_load_n(&alloc_counting, __ATOMIC_RELAXED))
+    __atomic_fetch_add(&alloc_calls, 1, __ATOMIC_RELAXED);
+}
+
+size_t alloc_count_calls(void) {
+  return __atomic_load_n(&alloc_calls, __ATOMIC_RELAXED);
+}
+
+void alloc_count_start(void) {
+  __atomic_store_n(&alloc_calls, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&alloc_counting, true, __ATOMIC_RELAXED);
+}
+
+void alloc_count_stop(void) {
+  __atomic_store_n(&alloc_counting, false, __ATOMIC_RELAXED);
+}
+
+void *alloc_count_malloc(size_t size) {
+  alloc_count_call();
+  return malloc(size);
+}
+
+void *alloc_count_calloc(size_t count, size_t size) {
+  alloc_count_call();
+  return calloc(count, size);
+}
+
+void *alloc_count_realloc(void *ptr, size_t size) {
+  alloc_count_call();
+  return realloc(ptr, size);
+}
+
+void *alloc_count_aligned_alloc(size_t alignment, size_t size) {
+  alloc_count_call();
+  return aligned_alloc(alignment, size);
+}
+
+void alloc_count_free(void *ptr) {
+  if (ptr)
+    alloc_count_call();
+  free(ptr);
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+// build.c force-includes this into every file of the test build, so the
+// malloc family calls written in the engine go through counters. Calls made
+// inside libc, GL or EGL are not seen, the driver allocates plenty per frame
+// on its own.
+//
+// Only compiler headers are included here: a libc header would settle the
+// feature macros before a file gets to define _GNU_SOURCE. <stdlib.h> then
+// declares the counting functions under the macros below, with the same
+// signatures.
+
+// Calls since the last alloc_count_start, frees of NULL excluded
+size_t alloc_count_calls(void);
+void alloc_count_start(void);
+void alloc_count_stop(void);
+
+void *alloc_count_malloc(size_t size);
+void *alloc_count_calloc(size_t count, size_t size);
+void *alloc_count_realloc(void *ptr, size_t size);
+void *alloc_count_aligned_alloc(size_t alignment, size_t size);
+void alloc_count_free(void *ptr);
+
+#define malloc(size) alloc_count_malloc(size)
+#define calloc(count, size) alloc_count_calloc(count, size)
+#define realloc(ptr, size) alloc_count_realloc(ptr, size)
+#define aligned_alloc(alignment, size)                                         \
+  alloc_count_aligned_alloc(alignment, size)
+#define free(ptr) alloc_count_free(ptr)
@@ -0,0 +1,107 @@
+#include "../src/utils/memory.h"
+#include "bench.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+// Every thread allocates ARENA_BENCH_ALLOCS small blocks and touches each,
+// then the memory goes back: one arena reset, or a free per block.
+
+#define ARENA_BENCH_ALLOCS 1000000
+#define ARENA_BENCH_ROUNDS 3
+#define ARENA_BENCH_MAX_THREADS 8
+
+typedef enum {
+  ARENA_BENCH_SHARED,
+  ARENA_BENCH_PER_THREAD,
+  ARENA_BENCH_MALLOC,
+} ArenaBenchMode;
+
+static Arena_Concurrent arena_bench_shared;
+static Arena arena_bench_locals[ARENA_BENCH_MAX_THREADS];
+static void **arena_bench_blocks[ARENA_BENCH_MAX_THREADS];
+static ArenaBenchMode arena_bench_mode;
+
+static size_t arena_bench_size(size_t i) { return 16 + (i * 7919) % 113; }
+
+static void *arena_bench_worker(void *arg) {
+  size_t thread = (size_t)arg;
+  for (size_t i = 0; i < ARENA_BENCH_ALLOCS; ++i) {
+    size_t size = arena_bench_size(i);
+    uintptr_t *p = NULL;
+    switch (arena_bench_mode) {
+    case ARENA_BENCH_SHARED:
+      p = (uintptr_t *)arena_concurrent_alloc(&arena_bench_shared, size);
+      break;
+    case ARENA_BENCH_PER_THREAD:
+      p = (uintptr_t *)arena_alloc(&arena_bench_locals[thread], size);
+      break;
+    case ARENA_BENCH_MALLOC:
+      p = (uintptr_t *)malloc(size);
+      arena_bench_blocks[thread][i] = p;
+      break;
+    }
+    p[0] = i;
+  }
+  return NULL;
+}
+
+static void *arena_bench_release(void *arg) {
+  size_t thread = (size_t)arg;
+  if (arena_bench_mode == ARENA_BENCH_PER_THREAD) {
+    arena_reset(&arena_bench_locals[thread]);
+  } else if (arena_bench_mode == ARENA_BENCH_MALLOC) {
+    for (size_t i = 0; i < ARENA_BENCH_ALLOCS; ++i)
+      free(arena_bench_blocks[thread][i]);
+  }
+  return NULL;
+}
+
+static void arena_bench_spawn(void *(*func)(void *), int threads) {
+  pthread_t handles[ARENA_BENCH_MAX_THREADS];
+  for (int t = 0; t < threads; ++t)
+    pthread_create(&handles[t], NULL, func, (void *)(size_t)t);
+  for (int t = 0; t < threads; ++t)
+    pthread_join(handles[t], NULL);
+}
+
+// Best of ARENA_BENCH_ROUNDS, in million allocations per second
+static double arena_bench_run(ArenaBenchMode mode, int threads) {
+  arena_bench_mode = mode;
+  double best = 0;
+  for (int round = 0; round < ARENA_BENCH_ROUNDS; ++round) {
+    double start = bench_time();
+    arena_bench_spawn(arena_bench_worker, threads);
+    arena_bench_spawn(arena_bench_release, threads);
+    if (mode == ARENA_BENCH_SHARED)
+      arena_concurrent_reset(&arena_bench_shared);
+    double seconds = bench_time() - start;
+    double rate = threads * (double)ARENA_BENCH_ALLOCS / seconds / 1e6;
+    if (rate > best)
+      best = rate;
+  }
+  return best;
+}
+
+void bench_arenas(void) {
+  for (int t = 0; t < ARENA_BENCH_MAX_THREADS; ++t) {
+    arena_bench_blocks[t] =
+        (void **)malloc(ARENA_BENCH_ALLOCS * sizeof(void *));
+  }
+
+  printf("%d allocations of 16-128 bytes per thread, then reset or free, "
+         "M allocs/s\n",
+         ARENA_BENCH_ALLOCS);
+  printf("threads  shared  per-thread  malloc\n");
+  for (int threads = 1; threads <= ARENA_BENCH_MAX_THREADS; threads *= 2) {
+    double shared = arena_bench_run(ARENA_BENCH_SHARED, threads);
+    double local = arena_bench_run(ARENA_BENCH_PER_THREAD, threads);
+    double heap = arena_bench_run(ARENA_BENCH_MALLOC, threads);
+    printf("%7d  %6.1f  %10.1f  %6.1f\n", threads, shared, local, heap);
+  }
+
+  arena_concurrent_free(&arena_bench_shared);
+  for (int t = 0; t < ARENA_BENCH_MAX_THREADS; ++t) {
+    arena_free(&arena_bench_locals[t]);
+    free(arena_bench_blocks[t]);
+  }
+}
@@ -0,0 +1,196 @@
+// Built once per arena backend by `./build test`, ARENA_BACKEND comes from
+// the command line. Under vmem one reservation serves everything here, only
+// the other backends chain regions.
+#define ARENA_CONCURRENT
+#define ARENA_IMPLEMENTATION
+#include "../libs/arena.h"
+#include "test.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+int test_failures = 0;
+
+#define ARENA_TEST_THREADS 8
+#define ARENA_TEST_ALLOCS 10000
+#define ARENA_TEST_ROUNDS 4
+
+typedef struct {
+  uintptr_t *words;
+  size_t count;
+} ArenaTestBlock;
+
+static Arena_Concurrent arena_test_shared;
+static ArenaTestBlock arena_test_blocks[ARENA_TEST_THREADS][ARENA_TEST_ALLOCS];
+
+static uintptr_t arena_test_tag(size_t thread, size_t i) {
+  return (uintptr_t)thread << 24 | i;
+}
+
+// Mostly small blocks, every 997th one larger than a default region
+static size_t arena_test_words(size_t i) {
+  if (i % 997 == 0)
+    return ARENA_REGION_DEFAULT_CAPACITY + ARENA_REGION_DEFAULT_CAPACITY / 2;
+  return 1 + (i * 7919) % 128;
+}
+
+static void *arena_test_worker(void *arg) {
+  size_t thread = (size_t)arg;
+  for (size_t i = 0; i < ARENA_TEST_ALLOCS; ++i) {
+    size_t count = arena_test_words(i);
+    uintptr_t *words = (uintptr_t *)arena_concurrent_alloc(
+        &arena_test_shared, count * sizeof(uintptr_t));
+    for (size_t k = 0; k < count; ++k)
+      words[k] = arena_test_tag(thread, i);
+    arena_test_blocks[thread][i] = (ArenaTestBlock){words, count};
+  }
+  return NULL;
+}
+
+static int arena_test_compare(const void *a, const void *b) {
+  uintptr_t x = (uintptr_t)((const ArenaTestBlock *)a)->words;
+  uintptr_t y = (uintptr_t)((const ArenaTestBlock *)b)->words;
+  return x < y ? -1 : x > y;
+}
+
+// Every block still holds its own tag and no two blocks overlap
+static void arena_test_check_blocks(void) {
+  size_t damaged = 0, misaligned = 0, overlaps = 0;
+  for (size_t t = 0; t < ARENA_TEST_THREADS; ++t) {
+    for (size_t i = 0; i < ARENA_TEST_ALLOCS; ++i) {
+      ArenaTestBlock *block = &arena_test_blocks[t][i];
+      if ((uintptr_t)block->words % sizeof(uintptr_t) != 0)
+        misaligned++;
+      for (size_t k = 0; k < block->count; ++k) {
+        if (block->words[k] != arena_test_tag(t, i)) {
+          damaged++;
+          break;
+        }
+      }
+    }
+  }
+
+  ArenaTestBlock *sorted = &arena_test_blocks[0][0];
+  size_t count = ARENA_TEST_THREADS * ARENA_TEST_ALLOCS;
+  qsort(sorted, count, sizeof(*sorted), arena_test_compare);
+  for (size_t i = 0; i + 1 < count; ++i) {
+    if (sorted[i].words + sorted[i].count > sorted[i + 1].words)
+      overlaps++;
+  }
+  CHECK(damaged == 0);
+  CHECK(misaligned == 0);
+  CHECK(overlaps == 0);
+}
+
+static void test_arena_concurrent(void) {
+  for (int round = 0; round < ARENA_TEST_ROUNDS; ++round) {
+    pthread_t threads[ARENA_TEST_THREADS];
+    for (size_t t = 0; t < ARENA_TEST_THREADS; ++t) {
+      pthread_create(&threads[t], NULL, arena_test_worker, (void *)t);
+    }
+    for (size_t t = 0; t < ARENA_TEST_THREADS; ++t) {
+      pthread_join(threads[t], NULL);
+    }
+    arena_test_check_blocks();
+
+    // Reset keeps the regions and starts over at the first one
+    Arena_Region *begin = arena_test_shared.begin;
+    arena_concurrent_reset(&arena_test_shared);
+    CHECK(arena_test_shared.begin == begin);
+    CHECK(arena_concurrent_alloc(&arena_test_shared, 1) == &begin->data[0]);
+    arena_concurrent_reset(&arena_test_shared);
+  }
+  arena_concurrent_free(&arena_test_shared);
+  CHECK(arena_test_shared.begin == NULL && arena_test_shared.end == NULL);
+}
+
+#define ARENA_TEST_ALIGNED_ALLOCS 20000
+
+typedef struct {
+  unsigned char *bytes;
+  size_t size;
+} ArenaTestAligned;
+
+static ArenaTestAligned arena_test_aligned[ARENA_TEST_ALIGNED_ALLOCS];
+
+typedef struct {
+  float *items;
+  size_t count;
+  size_t capacity;
+} ArenaTestFloats;
+
+// Alignments up to a page, past ARENA_REGION_ALIGNMENT, with sizes that keep
+// spilling into new regions and now and then outgrow a default one
+static void test_arena_aligned(void) {
+  static const size_t alignments[] = {1, 8, 16, 32, 64, 128, 256, 4096};
+  Arena arena = {0};
+  size_t misaligned = 0, damaged = 0;
+  for (size_t i = 0; i < ARENA_TEST_ALIGNED_ALLOCS; ++i) {
+    size_t count = sizeof(alignments) / sizeof(alignments[0]);
+    size_t alignment = alignments[i % count];
+    size_t size = 1 + (i * 7919) % 1500;
+    if (i % 1999 == 0)
+      size = ARENA_REGION_DEFAULT_CAPACITY * sizeof(uintptr_t) + 3;
+    unsigned char *bytes = arena_alloc_aligned(&arena, size, alignment);
+    if ((uintptr_t)bytes % alignment != 0 ||
+        (uintptr_t)bytes % sizeof(uintptr_t) != 0)
+      misaligned++;
+    memset(bytes, (int)(i & 0xff), size);
+    arena_test_aligned[i] = (ArenaTestAligned){bytes, size};
+  }
+  for (size_t i = 0; i < ARENA_TEST_ALIGNED_ALLOCS; ++i) {
+    ArenaTestAligned *a = &arena_test_aligned[i];
+    for (size_t k = 0; k < a->size; ++k) {
+      if (a->bytes[k] != (unsigned char)(i & 0xff)) {
+        damaged++;
+        break;
+      }
+    }
+  }
+  CHECK(misaligned == 0);
+  CHECK(damaged == 0);
+
+  // Regrowing copies into whatever region has room and keeps the alignment
+  ArenaTestFloats floats = {0};
+  size_t misaligned_items = 0, wrong_items = 0;
+  for (size_t i = 0; i < 100000; ++i) {
+    arena_alloc(&arena, 24);
+    arena_da_append_aligned(&arena, &floats, (float)i, 64);
+    if ((uintptr_t)floats.items % 64 != 0)
+      misaligned_items++;
+  }
+  for (size_t i = 0; i < floats.count; ++i) {
+    if (floats.items[i] != (float)i)
+      wrong_items++;
+  }
+  CHECK(misaligned_items == 0);
+  CHECK(wrong_items == 0);
+
+  size_t misaligned_regions = 0;
+  for (Arena_Region *r = arena.begin; r != NULL; r = r->next) {
+    if ((uintptr_t)r->data % ARENA_REGION_ALIGNMENT != 0)
+      misaligned_regions++;
+  }
+  CHECK(misaligned_regions == 0);
+
+  // A reset arena hands the same regions out again, still aligned
+  arena_reset(&arena);
+  CHECK((uintptr_t)arena_alloc_aligned(&arena, 1, 4096) % 4096 == 0);
+  arena_free(&arena);
+}
+
+int main(void) {
+  static const char *backends[] = {"libc", "mmap", "win32", "wasm", "vmem"};
+  printf("== arena (%s backend)\n", backends[ARENA_BACKEND]);
+  fflush(stdout);
+  int failures = 0;
+  test_arena_concurrent();
+  printf("arena_concurrent: %s\n", test_failures == 0 ? "ok" : "FAILED");
+  failures += test_failures;
+  test_failures = 0;
+  test_arena_aligned();
+  printf("arena_aligned: %s\n", test_failures == 0 ? "ok" : "FAILED");
+  failures += test_failures;
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+#include "bench.h"
+#include <stdbool.h>
+#include <string.h>
+
+typedef struct {
+  const char *name;
+  void (*run)(void);
+} Bench;
+
+static const Bench benches[] = {
+    {"shaders", bench_shaders},
+    {"arenas", bench_arenas},
+    {"pools", bench_pools},
+    {"jobs", bench_jobs},
+    {"text", bench_text},
+    {"scene", bench_scene},
+};
+
+#define BENCH_COUNT (sizeof(benches) / sizeof(benches[0]))
+
+static bool bench_selected(const char *name, int argc, char *argv[]) {
+  if (argc <= 1)
+    return true;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], name) == 0)
+      return true;
+  }
+  return false;
+}
+
+int main(int argc, char *argv[]) {
+  for (int i = 1; i < argc; ++i) {
+    size_t b = 0;
+    while (b < BENCH_COUNT && strcmp(benches[b].name, argv[i]) != 0)
+      b++;
+    if (b == BENCH_COUNT) {
+      fprintf(stderr, "Unknown benchmark: %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  for (size_t b = 0; b < BENCH_COUNT; ++b) {
+    if (!bench_selected(benches[b].name, argc, argv))
+      continue;
+    printf("== %s\n", benches[b].name);
+    fflush(stdout);
+    benches[b].run();
+    printf("\n");
+  }
+  return 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <stdio.h>
+#include <time.h>
+
+// Benchmarks run by `./build bench [name...]`, all of them without a name.
+// Each one prints its own results.
+
+static inline double bench_time(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void bench_shaders(void);
+void bench_arenas(void);
+void bench_pools(void);
+void bench_jobs(void);
+void bench_text(void);
+void bench_scene(void);
@@ -0,0 +1,48 @@
+#include "../src/control/game_app.h"
+#include "alloc_count.h"
+#include "test.h"
+
+// Headless frames after the warm-up must not malloc or free anything. The
+// first frames may still grow the draw lists.
+
+#define FRAME_ALLOC_WARMUP 10
+#define FRAME_ALLOC_FRAMES 120
+
+void test_frame_allocations(void) {
+  // The counter has to see calls from here, or zero would prove nothing
+  alloc_count_start();
+  void *volatile probe = malloc(16);
+  free(probe);
+  alloc_count_stop();
+  CHECK(alloc_count_calls() == 2);
+
+  GameAppCreateInfo appInfo = {0};
+  appInfo.width = 320;
+  appInfo.height = 180;
+  appInfo.font_path = "assets/fonts/ProtoNerdFont.ttf";
+  appInfo.headless = true;
+  appInfo.headlessFrames = FRAME_ALLOC_FRAMES;
+  appInfo.pathSegments = 64;
+  appInfo.sceneObjects = 64;
+  GameApp *app = game_app_create(&appInfo);
+  CHECK(app != NULL);
+  if (!app)
+    return;
+
+  int frames = 0;
+  returnCode code = CONTINUE;
+  while (code == CONTINUE) {
+    if (frames == FRAME_ALLOC_WARMUP)
+      alloc_count_start();
+    code = game_app_main_loop(app);
+    frames++;
+  }
+  alloc_count_stop();
+
+  printf("%zu malloc/free calls in %d frames after %d warm-up frames\n",
+         alloc_count_calls(), frames - FRAME_ALLOC_WARMUP,
+         FRAME_ALLOC_WARMUP);
+  CHECK(frames == FRAME_ALLOC_FRAMES);
+  CHECK(alloc_count_calls() == 0);
+  game_app_destroy(app);
+}
@@ -0,0 +1,173 @@
+#include "../src/renderer/gl_state.h"
+#include "test.h"
+#include <string.h>
+
+// gl_state against a backend that only records the calls reaching it, no
+// context needed. The real backend is put back at the end.
+
+#define GL_STATE_TEST_MAX_CALLS 64
+
+typedef struct {
+  const char *func;
+  GLuint a, b;
+} GlStateTestCall;
+
+static GlStateTestCall gl_state_test_log[GL_STATE_TEST_MAX_CALLS];
+static int gl_state_test_calls;
+
+static void gl_state_test_record(const char *func, GLuint a, GLuint b) {
+  if (gl_state_test_calls < GL_STATE_TEST_MAX_CALLS)
+    gl_state_test_log[gl_state_test_calls] = (GlStateTestCall){func, a, b};
+  gl_state_test_calls++;
+}
+
+static bool gl_state_test_called(int i, const char *func, GLuint a, GLuint b) {
+  return i < gl_state_test_calls && i < GL_STATE_TEST_MAX_CALLS &&
+         strcmp(gl_state_test_log[i].func, func) == 0 &&
+         gl_state_test_log[i].a == a && gl_state_test_log[i].b == b;
+}
+
+static void rec_use_program(GLuint program) {
+  gl_state_test_record("useProgram", program, 0);
+}
+static void rec_bind_vertex_array(GLuint vao) {
+  gl_state_test_record("bindVertexArray", vao, 0);
+}
+static void rec_bind_buffer(GLenum target, GLuint buffer) {
+  gl_state_test_record("bindBuffer", target, buffer);
+}
+static void rec_bind_framebuffer(GLenum target, GLuint framebuffer) {
+  gl_state_test_record("bindFramebuffer", target, framebuffer);
+}
+static void rec_active_texture(GLenum unit) {
+  gl_state_test_record("activeTexture", unit, 0);
+}
+static void rec_bind_texture(GLenum target, GLuint texture) {
+  gl_state_test_record("bindTexture", target, texture);
+}
+static void rec_enable(GLenum cap) { gl_state_test_record("enable", cap, 0); }
+static void rec_disable(GLenum cap) { gl_state_test_record("disable", cap, 0); }
+static void rec_blend_func(GLenum src, GLenum dst) {
+  gl_state_test_record("blendFunc", src, dst);
+}
+static void rec_color_mask(GLboolean r, GLboolean g, GLboolean b,
+                           GLboolean a) {
+  gl_state_test_record("colorMask", r | g << 1 | b << 2 | a << 3, 0);
+}
+static void rec_stencil_mask(GLuint mask) {
+  gl_state_test_record("stencilMask", mask, 0);
+}
+static void rec_viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+  (void)x;
+  (void)y;
+  gl_state_test_record("viewport", (GLuint)width, (GLuint)height);
+}
+
+static const GlBackend gl_state_test_backend = {
+    .useProgram = rec_use_program,
+    .bindVertexArray = rec_bind_vertex_array,
+    .bindBuffer = rec_bind_buffer,
+    .bindFramebuffer = rec_bind_framebuffer,
+    .activeTexture = rec_active_texture,
+    .bindTexture = rec_bind_texture,
+    .enable = rec_enable,
+    .disable = rec_disable,
+    .blendFunc = rec_blend_func,
+    .colorMask = rec_color_mask,
+    .stencilMask = rec_stencil_mask,
+    .viewport = rec_viewport,
+};
+
+// 13 calls, the stencil test is toggled on and off every frame and element
+// buffers are never tracked
+static void gl_state_test_frame(void) {
+  gl_state_viewport(0, 0, 960, 540);
+  gl_state_use_program(3);
+  gl_state_bind_vertex_array(1);
+  gl_state_bind_buffer(GL_ARRAY_BUFFER, 7);
+  gl_state_enable(GL_BLEND);
+  gl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  gl_state_bind_texture(0, GL_TEXTURE_2D, 5);
+  gl_state_bind_texture(2, GL_TEXTURE_2D, 6);
+  gl_state_enable(GL_STENCIL_TEST);
+  gl_state_disable(GL_STENCIL_TEST);
+  gl_state_bind_framebuffer(GL_FRAMEBUFFER, 9);
+  gl_state_bind_framebuffer(GL_DRAW_FRAMEBUFFER, 9);
+  gl_state_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 4);
+  gl_state_end_frame();
+}
+
+void test_gl_state(void) {
+  gl_state_init(&gl_state_test_backend);
+
+  // First frame: everything is unknown, only the draw framebuffer that the
+  // GL_FRAMEBUFFER bind just set is filtered. Unit switches are extra calls.
+  gl_state_test_calls = 0;
+  gl_state_test_frame();
+  GlStateCounters first = gl_state_last_frame();
+  CHECK(first.issued == 12 && first.filtered == 1);
+  CHECK(gl_state_test_calls == 12 + 2);
+
+  // Repeating it only issues what toggles
+  gl_state_test_calls = 0;
+  gl_state_test_frame();
+  GlStateCounters second = gl_state_last_frame();
+  CHECK(second.issued == 3 && second.filtered == 10);
+  CHECK(gl_state_test_calls == 3);
+  CHECK(gl_state_test_called(0, "enable", GL_STENCIL_TEST, 0));
+  CHECK(gl_state_test_called(1, "disable", GL_STENCIL_TEST, 0));
+  CHECK(gl_state_test_called(2, "bindBuffer", GL_ELEMENT_ARRAY_BUFFER, 4));
+
+  // Unit 2 is still active from the frame; going back to unit 0 issues
+  // glActiveTexture, which counts as neither issued nor filtered
+  GlStateCounters before = gl_state_total();
+  gl_state_test_calls = 0;
+  gl_state_bind_texture(2, GL_TEXTURE_2D, 8);
+  gl_state_bind_texture(0, GL_TEXTURE_2D, 5);
+  gl_state_bind_texture(0, GL_TEXTURE_2D, 10);
+  GlStateCounters after = gl_state_total();
+  CHECK(after.issued - before.issued == 2);
+  CHECK(after.filtered - before.filtered == 1);
+  CHECK(gl_state_test_calls == 3);
+  CHECK(gl_state_test_called(0, "bindTexture", GL_TEXTURE_2D, 8));
+  CHECK(gl_state_test_called(1, "activeTexture", GL_TEXTURE0, 0));
+  CHECK(gl_state_test_called(2, "bindTexture", GL_TEXTURE_2D, 10));
+
+  // After invalidate the same values go through once more, the active unit
+  // included
+  gl_state_invalidate();
+  gl_state_test_calls = 0;
+  gl_state_use_program(3);
+  gl_state_use_program(3);
+  gl_state_bind_texture(0, GL_TEXTURE_2D, 10);
+  gl_state_bind_texture(0, GL_TEXTURE_2D, 10);
+  CHECK(gl_state_test_calls == 3);
+  CHECK(gl_state_test_called(0, "useProgram", 3, 0));
+  CHECK(gl_state_test_called(1, "activeTexture", GL_TEXTURE0, 0));
+  CHECK(gl_state_test_called(2, "bindTexture", GL_TEXTURE_2D, 10));
+
+  // GL_FRAMEBUFFER sets both targets; binding one target leaves the other
+  // unknown or different, so a later GL_FRAMEBUFFER bind still goes through
+  gl_state_invalidate();
+  gl_state_test_calls = 0;
+  gl_state_bind_framebuffer(GL_FRAMEBUFFER, 2);
+  gl_state_bind_framebuffer(GL_DRAW_FRAMEBUFFER, 2);
+  gl_state_bind_framebuffer(GL_READ_FRAMEBUFFER, 2);
+  gl_state_bind_framebuffer(GL_READ_FRAMEBUFFER, 3);
+  gl_state_bind_framebuffer(GL_FRAMEBUFFER, 3);
+  gl_state_bind_framebuffer(GL_DRAW_FRAMEBUFFER, 3);
+  CHECK(gl_state_test_calls == 3);
+  CHECK(gl_state_test_called(0, "bindFramebuffer", GL_FRAMEBUFFER, 2));
+  CHECK(gl_state_test_called(1, "bindFramebuffer", GL_READ_FRAMEBUFFER, 3));
+  CHECK(gl_state_test_called(2, "bindFramebuffer", GL_FRAMEBUFFER, 3));
+
+  gl_state_invalidate();
+  gl_state_test_calls = 0;
+  gl_state_bind_framebuffer(GL_READ_FRAMEBUFFER, 5);
+  gl_state_bind_framebuffer(GL_FRAMEBUFFER, 5);
+  gl_state_bind_framebuffer(GL_FRAMEBUFFER, 5);
+  CHECK(gl_state_test_calls == 2);
+  CHECK(gl_state_test_called(1, "bindFramebuffer", GL_FRAMEBUFFER, 5));
+
+  gl_state_init(NULL);
+}
@@ -0,0 +1,78 @@
+#include "../src/jobs/jobs.h"
+#include "bench.h"
+#include <math.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// The same work at 1..N workers, N being twice the online cores but at
+// least 8: one large parallel_for, fork/join of nested parallel_fors, and
+// jobs too small to be worth stealing, which only measure the overhead.
+
+#define JOBS_BENCH_ITEMS (1 << 24)
+#define JOBS_BENCH_GRAIN 4096
+#define JOBS_BENCH_ROUNDS 10
+#define JOBS_BENCH_NESTED 200
+#define JOBS_BENCH_NESTED_ITEMS 10000
+#define JOBS_BENCH_TINY 100000
+
+static float *jobs_bench_data;
+static int64_t jobs_bench_sink;
+
+static void jobs_bench_sqrt(void *data, size_t begin, size_t end) {
+  (void)data;
+  for (size_t i = begin; i < end; ++i)
+    jobs_bench_data[i] = sqrtf((float)i) * 1.0001f;
+}
+
+static void jobs_bench_leaf(void *data, size_t begin, size_t end) {
+  (void)data;
+  __atomic_add_fetch(&jobs_bench_sink, (int64_t)(end - begin),
+                     __ATOMIC_RELAXED);
+}
+
+static void jobs_bench_outer(void *data, size_t begin, size_t end) {
+  (void)data;
+  (void)begin;
+  (void)end;
+  parallel_for(jobs_bench_leaf, NULL, JOBS_BENCH_NESTED_ITEMS, 64);
+}
+
+void bench_jobs(void) {
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  int max_workers = cores > 4 ? (int)cores * 2 : 8;
+  if (max_workers > JOB_MAX_WORKERS)
+    max_workers = JOB_MAX_WORKERS;
+  jobs_bench_data = (float *)malloc(JOBS_BENCH_ITEMS * sizeof(float));
+
+  printf("%ld online cores; parallel_for ms per %d items, fork/join ms for "
+         "%d nested parallel_fors, ns per tiny job\n",
+         cores, JOBS_BENCH_ITEMS, JOBS_BENCH_NESTED);
+  printf("workers  parallel_for  speedup  fork/join  tiny\n");
+  double base = 0;
+  for (int workers = 1; workers <= max_workers; workers *= 2) {
+    jobs_init(workers, false);
+
+    double start = bench_time();
+    for (int round = 0; round < JOBS_BENCH_ROUNDS; ++round)
+      parallel_for(jobs_bench_sqrt, NULL, JOBS_BENCH_ITEMS, JOBS_BENCH_GRAIN);
+    double parallel = (bench_time() - start) / JOBS_BENCH_ROUNDS;
+    if (workers == 1)
+      base = parallel;
+
+    JobCounter counter = {0};
+    start = bench_time();
+    jobs_run(jobs_bench_outer, NULL, JOBS_BENCH_NESTED, &counter);
+    jobs_wait(&counter);
+    double nested = bench_time() - start;
+
+    start = bench_time();
+    jobs_run(jobs_bench_leaf, NULL, JOBS_BENCH_TINY, &counter);
+    jobs_wait(&counter);
+    double tiny = bench_time() - start;
+
+    printf("%7d  %12.2f  %7.2f  %9.3f  %4.0f\n", workers, parallel * 1e3,
+           base / parallel, nested * 1e3, tiny * 1e9 / JOBS_BENCH_TINY);
+    jobs_shutdown();
+  }
+  free(jobs_bench_data);
+}
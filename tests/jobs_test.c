@@ -0,0 +1,88 @@
+#include "../src/jobs/jobs.h"
+#include "test.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// parallel_for has to hand every item to exactly one chunk, whatever the
+// worker count and however ranges get split and stolen.
+
+#define JOBS_TEST_ITEMS 1000003
+#define JOBS_TEST_NESTED_OUTER 64
+#define JOBS_TEST_NESTED_ITEMS 10000
+
+static uint8_t *jobs_test_hits;
+static int64_t jobs_test_nested;
+
+static void jobs_test_visit(void *data, size_t begin, size_t end) {
+  (void)data;
+  for (size_t i = begin; i < end; ++i)
+    __atomic_add_fetch(&jobs_test_hits[i], 1, __ATOMIC_RELAXED);
+}
+
+static void jobs_test_leaf(void *data, size_t begin, size_t end) {
+  (void)data;
+  __atomic_add_fetch(&jobs_test_nested, (int64_t)(end - begin),
+                     __ATOMIC_RELAXED);
+}
+
+// A job that forks its own parallel_for and joins it
+static void jobs_test_outer(void *data, size_t begin, size_t end) {
+  (void)data;
+  (void)begin;
+  (void)end;
+  parallel_for(jobs_test_leaf, NULL, JOBS_TEST_NESTED_ITEMS, 64);
+}
+
+static void *jobs_test_external(void *arg) {
+  (void)arg;
+  JobCounter counter = {0};
+  jobs_run(jobs_test_outer, NULL, JOBS_TEST_NESTED_OUTER, &counter);
+  jobs_wait(&counter);
+  return NULL;
+}
+
+static void jobs_test_parallel_for(size_t grain) {
+  memset(jobs_test_hits, 0, JOBS_TEST_ITEMS);
+  parallel_for(jobs_test_visit, NULL, JOBS_TEST_ITEMS, grain);
+  size_t missed = 0, repeated = 0;
+  for (size_t i = 0; i < JOBS_TEST_ITEMS; ++i) {
+    missed += jobs_test_hits[i] == 0;
+    repeated += jobs_test_hits[i] > 1;
+  }
+  CHECK(missed == 0);
+  CHECK(repeated == 0);
+}
+
+void test_jobs(void) {
+  static const int workers[] = {1, 2, 4, 8};
+  jobs_test_hits = (uint8_t *)malloc(JOBS_TEST_ITEMS);
+  for (size_t w = 0; w < sizeof(workers) / sizeof(workers[0]); ++w) {
+    CHECK(jobs_init(workers[w], false));
+    CHECK(jobs_worker_count() == workers[w]);
+
+    jobs_test_parallel_for(1);
+    jobs_test_parallel_for(64);
+    jobs_test_parallel_for(4096);
+
+    // Jobs submitting and waiting on their own jobs, from worker 0 and from
+    // a thread outside the system
+    jobs_test_nested = 0;
+    JobCounter counter = {0};
+    jobs_run(jobs_test_outer, NULL, JOBS_TEST_NESTED_OUTER, &counter);
+    jobs_wait(&counter);
+    CHECK(counter.pending == 0);
+    CHECK(jobs_test_nested ==
+          (int64_t)JOBS_TEST_NESTED_OUTER * JOBS_TEST_NESTED_ITEMS);
+
+    jobs_test_nested = 0;
+    pthread_t external;
+    pthread_create(&external, NULL, jobs_test_external, NULL);
+    pthread_join(external, NULL);
+    CHECK(jobs_test_nested ==
+          (int64_t)JOBS_TEST_NESTED_OUTER * JOBS_TEST_NESTED_ITEMS);
+
+    jobs_shutdown();
+  }
+  free(jobs_test_hits);
+}
@@ -0,0 +1,85 @@
+#include "../src/utils/pool.h"
+#include "bench.h"
+#include <malloc.h>
+#include <stdlib.h>
+
+// POOL_BENCH_ITEMS path segment sized objects: allocate them all, then
+// churn by freeing and reallocating every other one. Memory is what the
+// allocator holds for the live objects, headers and padding included.
+
+#define POOL_BENCH_ITEMS 1000000
+#define POOL_BENCH_CHURN 10
+
+typedef struct {
+  float p1[2], p2[2], p3[2];
+  int kind;
+} PoolBenchItem;
+
+static void *pool_bench_items[POOL_BENCH_ITEMS];
+
+static void pool_bench_print(const char *name, double alloc, double churn,
+                             size_t bytes) {
+  printf("%-13s %7.1f  %7.1f  %9zu  %5.1f\n", name,
+         alloc * 1e9 / POOL_BENCH_ITEMS,
+         churn * 1e9 / (POOL_BENCH_CHURN * POOL_BENCH_ITEMS), bytes,
+         bytes / (double)POOL_BENCH_ITEMS);
+}
+
+static void pool_bench_pool(int flags) {
+  Arena arena = {0};
+  Pool pool;
+  pool_init_typed(&pool, &arena, PoolBenchItem, flags);
+
+  double start = bench_time();
+  for (size_t i = 0; i < POOL_BENCH_ITEMS; ++i)
+    pool_bench_items[i] = pool_alloc_typed(&pool, PoolBenchItem);
+  double alloc = bench_time() - start;
+
+  size_t bytes = 0;
+  for (Arena_Region *r = arena.begin; r != NULL; r = r->next)
+    bytes += r->count * sizeof(uintptr_t);
+
+  start = bench_time();
+  for (int round = 0; round < POOL_BENCH_CHURN; ++round) {
+    for (size_t i = 0; i < POOL_BENCH_ITEMS; i += 2)
+      pool_free(&pool, pool_bench_items[i]);
+    for (size_t i = 0; i < POOL_BENCH_ITEMS; i += 2)
+      pool_bench_items[i] = pool_alloc(&pool);
+  }
+  double churn = bench_time() - start;
+
+  pool_bench_print(flags & POOL_HANDLES ? "pool+handles" : "pool", alloc,
+                   churn, bytes);
+  arena_free(&arena);
+}
+
+static void pool_bench_malloc(void) {
+  struct mallinfo2 before = mallinfo2();
+  double start = bench_time();
+  for (size_t i = 0; i < POOL_BENCH_ITEMS; ++i)
+    pool_bench_items[i] = malloc(sizeof(PoolBenchItem));
+  double alloc = bench_time() - start;
+  size_t bytes = mallinfo2().uordblks - before.uordblks;
+
+  start = bench_time();
+  for (int round = 0; round < POOL_BENCH_CHURN; ++round) {
+    for (size_t i = 0; i < POOL_BENCH_ITEMS; i += 2)
+      free(pool_bench_items[i]);
+    for (size_t i = 0; i < POOL_BENCH_ITEMS; i += 2)
+      pool_bench_items[i] = malloc(sizeof(PoolBenchItem));
+  }
+  double churn = bench_time() - start;
+
+  pool_bench_print("malloc", alloc, churn, bytes);
+  for (size_t i = 0; i < POOL_BENCH_ITEMS; ++i)
+    free(pool_bench_items[i]);
+}
+
+void bench_pools(void) {
+  printf("%d objects of %zu bytes, ns per alloc / per churn op\n",
+         POOL_BENCH_ITEMS, sizeof(PoolBenchItem));
+  printf("allocator       alloc    churn      bytes  B/obj\n");
+  pool_bench_pool(0);
+  pool_bench_pool(POOL_HANDLES);
+  pool_bench_malloc();
+}
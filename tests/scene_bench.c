@@ -0,0 +1,106 @@
+#include "../src/control/game_app.h"
+#include "bench.h"
+
+// SCENE_BENCH_MESHES polygons drawn 1k and 10k times per frame through
+// geometry_pool_flush, with multi-draw-indirect and with one draw call per
+// object. Times are per frame for the flush and for the flush up to
+// glFinish.
+
+#define SCENE_BENCH_WIDTH 1920
+#define SCENE_BENCH_HEIGHT 1080
+#define SCENE_BENCH_MESHES 6
+#define SCENE_BENCH_WARMUP 10
+#define SCENE_BENCH_FRAMES 100
+
+static int scene_bench_meshes(GeometryPool *pool) {
+  for (int m = 0; m < SCENE_BENCH_MESHES; ++m) {
+    int sides = 3 + m;
+    GeometryVertex vertices[9] = {{0, 0, 0xFFFFFFFF}};
+    uint32_t indices[8 * 3];
+    for (int i = 0; i < sides; ++i) {
+      float a = 2.0f * (float)M_PI * i / sides;
+      vertices[1 + i] = (GeometryVertex){cosf(a), sinf(a), 0x3D8BFFFF};
+      indices[3 * i] = 0;
+      indices[3 * i + 1] = 1 + i;
+      indices[3 * i + 2] = 1 + (i + 1) % sides;
+    }
+    if (geometry_pool_add_mesh(pool, vertices, 1 + sides, indices,
+                               3 * sides) < 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static void scene_bench_run(GameApp *app, bool indirect, int objects) {
+  GeometryPool pool;
+  if (!geometry_pool_create(&pool, &app->stream, 1024, 1024, indirect))
+    return;
+  if (!scene_bench_meshes(&pool)) {
+    geometry_pool_destroy(&pool);
+    return;
+  }
+
+  int columns = (int)ceilf(sqrtf((float)objects * SCENE_BENCH_WIDTH /
+                                 SCENE_BENCH_HEIGHT));
+  int rows = (objects + columns - 1) / columns;
+  float cellWidth = (float)SCENE_BENCH_WIDTH / columns;
+  float cellHeight = (float)SCENE_BENCH_HEIGHT / rows;
+  double flush = 0, finish = 0;
+  for (int frame = 0; frame < SCENE_BENCH_WARMUP + SCENE_BENCH_FRAMES;
+       ++frame) {
+    GLCall(glClear(GL_COLOR_BUFFER_BIT));
+    geometry_pool_begin(&pool);
+    for (int i = 0; i < objects; ++i) {
+      GeometryDraw draw = {
+          .x = (i % columns + 0.5f) * cellWidth,
+          .y = (i / columns + 0.5f) * cellHeight,
+          .scale = 0.45f * (cellWidth < cellHeight ? cellWidth : cellHeight),
+          .rotation = frame * 0.01f * (1.0f + (i % 7) * 0.25f),
+          .r = 1.0f,
+          .g = 1.0f,
+          .b = 1.0f,
+          .a = 0.8f,
+      };
+      geometry_pool_draw(&pool, i % SCENE_BENCH_MESHES, &draw);
+    }
+    double start = bench_time();
+    geometry_pool_flush(&pool, SCENE_BENCH_WIDTH, SCENE_BENCH_HEIGHT);
+    double flushed = bench_time();
+    GLCall(glFinish());
+    buffer_ring_end_frame(&app->stream);
+    if (frame < SCENE_BENCH_WARMUP)
+      continue;
+    flush += flushed - start;
+    finish += bench_time() - start;
+  }
+
+  // The pool falls back to direct draws without GL 4.3
+  printf("%7d  %-8s  %8.3f  %9.3f\n", objects,
+         pool.indirect ? "indirect" : "direct",
+         flush * 1e3 / SCENE_BENCH_FRAMES, finish * 1e3 / SCENE_BENCH_FRAMES);
+  geometry_pool_destroy(&pool);
+}
+
+void bench_scene(void) {
+  GameAppCreateInfo appInfo = {0};
+  appInfo.width = SCENE_BENCH_WIDTH;
+  appInfo.height = SCENE_BENCH_HEIGHT;
+  appInfo.font_path = "assets/fonts/ProtoNerdFont.ttf";
+  appInfo.headless = true;
+  appInfo.headlessFrames = 1;
+  GameApp *app = game_app_create(&appInfo);
+  if (!app)
+    return;
+
+  gl_state_viewport(0, 0, SCENE_BENCH_WIDTH, SCENE_BENCH_HEIGHT);
+
+  static const int objects[] = {1000, 10000};
+  printf("objects  mode      flush ms  finish ms\n");
+  for (size_t o = 0; o < sizeof(objects) / sizeof(objects[0]); ++o) {
+    scene_bench_run(app, true, objects[o]);
+    scene_bench_run(app, false, objects[o]);
+  }
+
+  game_app_destroy(app);
+}
@@ -0,0 +1,74 @@
+#include "../src/control/game_app.h"
+#include "bench.h"
+#include <dirent.h>
+#include <unistd.h>
+
+#define SHADER_BENCH_CACHE "build/bench_shader_cache"
+#define SHADER_BENCH_DRIVER_CACHE "build/bench_driver_cache"
+#define SHADER_BENCH_ROUNDS 3
+
+// Empties `directory` recursively, keeping the directory itself
+static void shader_bench_clear(const char *directory) {
+  DIR *dir = opendir(directory);
+  if (!dir)
+    return;
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+      continue;
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+    if (unlink(path) != 0) {
+      shader_bench_clear(path);
+      rmdir(path);
+    }
+  }
+  closedir(dir);
+}
+
+// A headless startup with every renderer on, so every program gets created
+static ShaderCacheStats shader_bench_startup(void) {
+  GameAppCreateInfo appInfo = {0};
+  appInfo.width = 320;
+  appInfo.height = 180;
+  appInfo.font_path = "assets/fonts/ProtoNerdFont.ttf";
+  appInfo.shaderCachePath = SHADER_BENCH_CACHE;
+  appInfo.headless = true;
+  appInfo.headlessFrames = 1;
+  appInfo.pathSegments = 16;
+  appInfo.sceneObjects = 16;
+
+  ShaderCacheStats stats = {0};
+  GameApp *app = game_app_create(&appInfo);
+  if (app) {
+    stats = shader_cache_stats();
+    game_app_destroy(app);
+  }
+  return stats;
+}
+
+// Cold start with an empty cache, then a warm start reading it back
+void bench_shaders(void) {
+  // Mesa's own disk cache would turn the cold start into a warm one. It
+  // can't be disabled, Mesa offers no binary formats without it.
+  setenv("MESA_SHADER_CACHE_DIR", SHADER_BENCH_DRIVER_CACHE, 1);
+
+  ShaderCacheStats cold[SHADER_BENCH_ROUNDS], warm[SHADER_BENCH_ROUNDS];
+  for (int i = 0; i < SHADER_BENCH_ROUNDS; ++i) {
+    shader_bench_clear(SHADER_BENCH_CACHE);
+    shader_bench_clear(SHADER_BENCH_DRIVER_CACHE);
+    cold[i] = shader_bench_startup();
+    warm[i] = shader_bench_startup();
+  }
+  shader_bench_clear(SHADER_BENCH_CACHE);
+  shader_bench_clear(SHADER_BENCH_DRIVER_CACHE);
+  rmdir(SHADER_BENCH_CACHE);
+  rmdir(SHADER_BENCH_DRIVER_CACHE);
+
+  for (int i = 0; i < SHADER_BENCH_ROUNDS; ++i) {
+    printf("round %d: cold %.3f ms (%d compiled), warm %.3f ms (%d cached, "
+           "%d rejected)\n",
+           i, cold[i].seconds * 1000.0, cold[i].misses,
+           warm[i].seconds * 1000.0, warm[i].hits, warm[i].rejected);
+  }
+}
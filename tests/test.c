@@ -0,0 +1,59 @@
+#include "test.h"
+#include <stdbool.h>
+#include <string.h>
+
+int test_failures = 0;
+
+typedef struct {
+  const char *name;
+  void (*run)(void);
+} Test;
+
+static const Test tests[] = {
+    {"frame_allocations", test_frame_allocations},
+    {"jobs", test_jobs},
+    {"gl_state", test_gl_state},
+};
+
+#define TEST_COUNT (sizeof(tests) / sizeof(tests[0]))
+
+static bool test_selected(const char *name, int argc, char *argv[]) {
+  if (argc <= 1)
+    return true;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], name) == 0)
+      return true;
+  }
+  return false;
+}
+
+int main(int argc, char *argv[]) {
+  for (int i = 1; i < argc; ++i) {
+    size_t t = 0;
+    while (t < TEST_COUNT && strcmp(tests[t].name, argv[i]) != 0)
+      t++;
+    if (t == TEST_COUNT) {
+      fprintf(stderr, "Unknown test: %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  int failed = 0;
+  for (size_t t = 0; t < TEST_COUNT; ++t) {
+    if (!test_selected(tests[t].name, argc, argv))
+      continue;
+    printf("== %s\n", tests[t].name);
+    fflush(stdout);
+    int before = test_failures;
+    tests[t].run();
+    bool ok = test_failures == before;
+    printf("%s: %s\n", tests[t].name, ok ? "ok" : "FAILED");
+    failed += !ok;
+  }
+
+  if (failed > 0) {
+    printf("\n%d test(s) failed\n", failed);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <stdio.h>
+
+// Tests run by `./build test [name...]`, all of them without a name. CHECK
+// reports a failure and carries on, the run fails if any CHECK did.
+
+extern int test_failures;
+
+#define CHECK(x)                                                               \
+  do {                                                                         \
+    if (!(x)) {                                                                \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #x);    \
+      test_failures++;                                                         \
+    }                                                                          \
+  } while (0)
+
+void test_frame_allocations(void);
+void test_jobs(void);
+void test_gl_state(void);
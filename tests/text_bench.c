@@ -0,0 +1,90 @@
+#include "../src/control/game_app.h"
+#include "bench.h"
+
+// A 1080p screen full of 16px debug text in three cases: nothing changes,
+// one line changes (a frame counter), every instance moves. Times are per
+// frame for building the instances, for the flush and for the flush up to
+// glFinish, plus the instance bytes the flush uploaded.
+
+#define TEXT_BENCH_WIDTH 1920
+#define TEXT_BENCH_HEIGHT 1080
+#define TEXT_BENCH_COLUMNS 200
+#define TEXT_BENCH_WARMUP 10
+#define TEXT_BENCH_FRAMES 100
+
+typedef enum {
+  TEXT_BENCH_STATIC,
+  TEXT_BENCH_ONE_LINE,
+  TEXT_BENCH_SCROLL,
+} TextBenchCase;
+
+static const char *text_bench_words =
+    "The quick brown fox jumps over the lazy dog; 0123456789 ";
+
+static void text_bench_build(TextRenderer *tr, TextBenchCase c, int frame) {
+  char line[TEXT_BENCH_COLUMNS + 1];
+  size_t words = strlen(text_bench_words);
+  int lines = TEXT_BENCH_HEIGHT / tr->lineHeight;
+  size_t shift = c == TEXT_BENCH_SCROLL ? (size_t)frame : 0;
+
+  text_renderer_begin(tr);
+  for (int row = 0; row < lines; ++row) {
+    for (size_t i = 0; i < TEXT_BENCH_COLUMNS; ++i)
+      line[i] = text_bench_words[(row + i + shift) % words];
+    line[TEXT_BENCH_COLUMNS] = '\0';
+    if (row == 0 && c == TEXT_BENCH_ONE_LINE)
+      snprintf(line, sizeof(line), "frame %06d", frame);
+    text_renderer_draw_string(tr, 0, (float)(row * tr->lineHeight), line,
+                              0xFFFFFFFF);
+  }
+}
+
+void bench_text(void) {
+  GameAppCreateInfo appInfo = {0};
+  appInfo.width = TEXT_BENCH_WIDTH;
+  appInfo.height = TEXT_BENCH_HEIGHT;
+  appInfo.font_path = "assets/fonts/ProtoNerdFont.ttf";
+  appInfo.headless = true;
+  appInfo.headlessFrames = 1;
+  GameApp *app = game_app_create(&appInfo);
+  if (!app)
+    return;
+  TextRenderer tr;
+  if (!text_renderer_init(&tr, appInfo.font_path, 16)) {
+    game_app_destroy(app);
+    return;
+  }
+
+  gl_state_viewport(0, 0, TEXT_BENCH_WIDTH, TEXT_BENCH_HEIGHT);
+
+  static const char *names[] = {"static", "one line", "scroll"};
+  printf("case       instances  build ms  flush ms  finish ms  upload B\n");
+  for (int c = TEXT_BENCH_STATIC; c <= TEXT_BENCH_SCROLL; ++c) {
+    double build = 0, flush = 0, finish = 0;
+    size_t uploaded = 0;
+    for (int frame = 0; frame < TEXT_BENCH_WARMUP + TEXT_BENCH_FRAMES;
+         ++frame) {
+      GLCall(glClear(GL_COLOR_BUFFER_BIT));
+      double start = bench_time();
+      text_bench_build(&tr, (TextBenchCase)c, frame);
+      double built = bench_time();
+      text_renderer_flush(&tr, TEXT_BENCH_WIDTH, TEXT_BENCH_HEIGHT);
+      double flushed = bench_time();
+      GLCall(glFinish());
+      if (frame < TEXT_BENCH_WARMUP)
+        continue;
+      build += built - start;
+      flush += flushed - built;
+      finish += bench_time() - built;
+      if (tr.dirtyBegin < tr.dirtyEnd)
+        uploaded += (tr.dirtyEnd - tr.dirtyBegin) * sizeof(TextInstance);
+    }
+    printf("%-9s  %9zu  %8.3f  %8.3f  %9.3f  %8zu\n", names[c], tr.count,
+           build * 1e3 / TEXT_BENCH_FRAMES, flush * 1e3 / TEXT_BENCH_FRAMES,
+           finish * 1e3 / TEXT_BENCH_FRAMES,
+           uploaded / TEXT_BENCH_FRAMES);
+  }
+
+  text_renderer_destroy(&tr);
+  game_app_destroy(app);
+}